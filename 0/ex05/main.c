@@ -1,16 +1,6 @@
 #include <avr/io.h>
 #include <util/delay.h>
-
-void display(int n) {
-	//Switch all LEDs off
-	PORTB &= ~((1 << PB0) | (1 << PB1) | (1 << PB2) | (1 << PB4));
-	//Deal with third LED not being PORTB3
-	if (n & 0b1000) {
-		PORTB |= (1 << PB4);
-	}
-	//Display the nice bits
-	PORTB |= n & 0b111;
-}
+#include "led.h"
 
 int main() {
 	//Set direction of B0, B1, B2, and B4 to output
@@ -18,7 +8,7 @@ int main() {
 	//Set direction of D2 and D4 to output
 	DDRD &= ~((1 << DDD2) | (1 << DDD4));
 	unsigned int n = 0;
-	display(n);
+	display_n_led(n);
 	int sw1_state = (PIND & (1 << PD2));
 	int sw2_state = (PIND & (1 << PD4));
 	while (1) {
@@ -27,7 +17,7 @@ int main() {
 			sw1_state = (PIND & (1 << PD2));
 			if (!sw1_state) {
 				n++;
-				display(n);
+				display_n_led(n);
 			}
 			//Wait 20ms to avoid bounce
 			_delay_ms(20);
@@ -37,7 +27,7 @@ int main() {
 			sw2_state = (PIND & (1 << PD4));
 			if (!sw2_state) {
 				n--;
-				display(n);
+				display_n_led(n);
 			}
 			//Wait 20ms to avoid bounce
 			_delay_ms(20);
@@ -1,16 +1,6 @@
 #include <avr/io.h>
 #include <util/delay.h>
-
-void display(int n) {
-	//Switch all LEDs off
-	PORTB &= ~((1 << PB0) | (1 << PB1) | (1 << PB2) | (1 << PB4));
-	//Deal with third LED not being PORTB3
-	if (n & 0b1000) {
-		PORTB |= (1 << PB4);
-	}
-	//Display the nice bits
-	PORTB |= n & 0b111;
-}
+#include "led.h"
 
 int main() {
 	//Set direction of B0, B1, B2, and B4 to output
@@ -18,7 +8,7 @@ int main() {
 	unsigned int n = 1;
 	int direction = 1;
 	while (1) {
-		display(n);
+		display_n_led(n);
 		if (direction)
 			n *= 2;
 		else
@@ -1,23 +1,7 @@
 #include <avr/io.h>
 #include <util/delay.h>
 #include <avr/interrupt.h>
-
-void uart_init() {
-	//Enable transmitter on USART0
-	UCSR0B |= (1 << TXEN0);
-	//Keep defaults : async with no parity and 1 stop bit
-	//Set character size to 8 bits
-	UCSR0C |= (1 << UCSZ00) | (1 << UCSZ00);
-	//Set baud rate to UART_BAUDRATE
-	UBRR0 = (F_CPU / 8 / UART_BAUDRATE - 1) / 2;
-}
-
-void uart_tx(char c) {
-	//Wait for USART to be ready to transmit
-	while (!(UCSR0A & (1 << UDRE0))) {}
-	//Transmit character
-	UDR0 = c;
-}
+#include "uart.h"
 
 ISR(TIMER1_COMPA_vect) {
 	uart_tx('Z');
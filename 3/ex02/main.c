@@ -1,42 +1,14 @@
 #include <avr/io.h>
 #include <util/delay.h>
 #include <avr/interrupt.h>
-
-void uart_init() {
-	//Enable transmitter and receiver on USART0
-	UCSR0B |= (1 << TXEN0) | (1 << RXEN0);
-	//Keep defaults : async with no parity and 1 stop bit
-	//Set character size to 8 bits
-	UCSR0C |= (1 << UCSZ00) | (1 << UCSZ00);
-	//Set baud rate to UART_BAUDRATE
-	UBRR0 = (F_CPU / 8 / UART_BAUDRATE - 1) / 2;
-}
-
-void uart_tx(char c) {
-	//Wait for USART to be ready to transmit
-	while (!(UCSR0A & (1 << UDRE0))) {}
-	//Transmit character
-	UDR0 = c;
-}
-
-char uart_rx() {
-	//Wait for USART0 to have received something
-	while (!(UCSR0A & (1 << RXC0))) {}
-	//Return received character
-	return (UDR0);
-}
-
-void uart_printstr(const char *str) {
-	for (int i = 0; str[i]; i++) {
-		uart_tx(str[i]);
-	}
-}
+#include "uart.h"
 
 int main() {
-	char c;
 	uart_init();
+	uart_rx_init();
 	while (1) {
-		c = uart_rx();
-		uart_tx(c);
+		//Echo whatever the RX interrupt has buffered, main is free otherwise
+		if (uart_rx_available())
+			uart_tx(uart_rx());
 	}
 }
@@ -1,84 +1,42 @@
 #include <avr/io.h>
 #include <util/delay.h>
 #include <avr/interrupt.h>
+#include "uart.h"
 
 #define MAX_INPUT_SIZE 100
 
-void uart_init() {
-	//Enable transmitter and receiver on USART0
-	UCSR0B |= (1 << TXEN0) | (1 << RXEN0);
-	//Keep defaults : async with no parity and 1 stop bit
-	//Set character size to 8 bits
-	UCSR0C |= (1 << UCSZ00) | (1 << UCSZ00);
-	//Set baud rate to UART_BAUDRATE
-	UBRR0 = (F_CPU / 8 / UART_BAUDRATE - 1) / 2;
-}
+enum login_status_e {
+	login_pending,
+	login_done,
+	login_too_long
+};
 
-void uart_tx(char c) {
-	//Wait for USART to be ready to transmit
-	while (!(UCSR0A & (1 << UDRE0))) {}
-	//Transmit character
-	UDR0 = c;
-}
+char user_input[MAX_INPUT_SIZE];
+char pass_input[MAX_INPUT_SIZE];
+uart_line user_line;
+uart_line pass_line;
+uart_line *current_line;
 
-char uart_rx() {
-	//Wait for USART0 to have received something
-	while (!(UCSR0A & (1 << RXC0))) {}
-	//Return received character
-	return (UDR0);
-}
-
-void uart_printstr(const char *str) {
-	for (int i = 0; str[i]; i++) {
-		uart_tx(str[i]);
-	}
-}
-
-int get_user_login(char *user, char *pass) {
+void prompt_user_login() {
 	uart_printstr("Enter your login:\r\n");
 	uart_printstr("\tusername: ");
-	int i = 0;
-	while (i < MAX_INPUT_SIZE) {
-		user[i] = uart_rx();
-		if (user[i] == 127 && i != 0) {
-			uart_printstr("\b \b");
-			i--;
-			continue;
-		}
-		if (user[i] == '\r') {
-			user[i] = 0;
-			break;
-		}
-		if (user[i] >= 20 && user[i] < 127)
-			uart_tx(user[i]);
-		if (user[i] != 127)
-			i++;
-	}
-	uart_printstr("\r\n");
-	if (i == MAX_INPUT_SIZE)
-		return (-1);
-	uart_printstr("\tpassword: ");
-	i = 0;
-	while (i < MAX_INPUT_SIZE) {
-		pass[i] = uart_rx();
-		if (pass[i] == 127 && i != 0) {
-			uart_printstr("\b \b");
-			i--;
-			continue;
-		}
-		if (pass[i] == '\r') {
-			pass[i] = 0;
-			break;
+	current_line = &user_line;
+}
+
+enum login_status_e poll_user_login() {
+	switch (uart_line_poll(current_line)) {
+	case uart_line_ready:
+		if (current_line == &user_line) {
+			uart_printstr("\tpassword: ");
+			current_line = &pass_line;
+			return (login_pending);
 		}
-		if (pass[i] >= 20 && pass[i] < 127)
-			uart_tx('*');
-		if (pass[i] != 127)
-			i++;
+		return (login_done);
+	case uart_line_too_long:
+		return (login_too_long);
+	default:
+		return (login_pending);
 	}
-	uart_printstr("\r\n");
-	if (i == MAX_INPUT_SIZE)
-		return (-1);
-	return (0);
 }
 
 int str_match(const char *str1, const char *str2) {
@@ -119,13 +77,19 @@ void display_led_animation() {
 int main() {
 	char *user = "maxime";
 	char *pass = "password";
-	char user_input[MAX_INPUT_SIZE];
-	char pass_input[MAX_INPUT_SIZE];
 	uart_init();
+	uart_rx_init();
+	uart_line_init(&user_line, user_input, MAX_INPUT_SIZE, uart_echo_on);
+	uart_line_init(&pass_line, pass_input, MAX_INPUT_SIZE, uart_echo_masked);
 	DDRB |= (1 << DDB0) | (1 << DDB1) | (1 << DDB2) | (1 << DDB4);
+	prompt_user_login();
 	while (1) {
-		if (get_user_login(user_input, pass_input)) {
+		enum login_status_e status = poll_user_login();
+		if (status == login_pending)
+			continue;
+		if (status == login_too_long) {
 			uart_printstr("Input is too long\r\n\r\n");
+			prompt_user_login();
 			continue;
 		}
 		if (str_match(user, user_input) && str_match(pass, pass_input)) {
@@ -136,5 +100,6 @@ int main() {
 		} else {
 			uart_printstr("Bad combinaison username/password\r\n\r\n");
 		}
+		prompt_user_login();
 	}
 }
@@ -1,49 +1,11 @@
 #include <avr/io.h>
 #include <util/delay.h>
 #include <avr/interrupt.h>
+#include "colour.h"
+#include "rgb.h"
 
 uint8_t position = 0;
 
-void init_rgb() {
-	//Set RGB LED to output
-	DDRD |= (1 << DDD3) | (1 << DDD5) | (1 << DDD6);
-	//Set timer 0 and 2 to 0
-	TCNT0 = 0;
-	TCNT2 = 0;
-	//Set timers to PWM phase correct mode
-	TCCR0A |= (1 << WGM00);
-	TCCR2A |= (1 << WGM20);
-	//Set Output Compare to 0 to initialise LED off
-	OCR0A = 0;
-	OCR0B = 0;
-	OCR2B = 0;
-	//Set timers to non inverted mode switches LEDs off when counting up and on when down
-	TCCR0A |= (1 << COM0A1) | (1 << COM0B1);
-	TCCR2A |= (1 << COM2B1);
-	//Set timer clocks with no prescaler
-	TCCR0B |= ((1 << CS00));
-	TCCR2B |= ((1 << CS20));
-}
-
-void set_rgb(uint8_t r, uint8_t g, uint8_t b) {
-	OCR0B = r;
-	OCR0A = g;
-	OCR2B = b;
-}
-
-void wheel(uint8_t pos) {
-	pos = 255 - pos;
-	if (pos < 85) {
-		set_rgb(255 - pos * 3, 0, pos * 3);
-	} else if (pos < 170) {
-		pos = pos - 85;
-		set_rgb(0, pos * 3, 255 - pos * 3);
-	} else {
-		pos = pos - 170;
-		set_rgb(pos * 3, 255 - pos * 3, 0);
-	}
-}
-
 void init_wheel() {
 	//Set timer 1 to 0
 	TCNT1 = 0;
@@ -60,12 +22,13 @@ void init_wheel() {
 }
 
 ISR(TIMER1_COMPA_vect) {
-	wheel(position);
+	rgb_colour c = wheel(position);
+	set_rgb(c.r, c.g, c.b);
 	position++;
 }
 
 int main() {
-	init_rgb();
+	rgb_init();
 	init_wheel();
 	while (1) {}
 }
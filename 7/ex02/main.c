@@ -1,6 +1,12 @@
 #include <avr/io.h>
 #include <util/delay.h>
 #include <avr/interrupt.h>
+//Timer 1 triggers the scans, the profiler samples timer 0 instead
+#define PROF_TIMER0
+#include "adc.h"
+#include "adc_scan.h"
+#include "prof.h"
+#include "uart.h"
 
 enum sensors {
 	potentiometer,
@@ -8,80 +14,16 @@ enum sensors {
 	thermistor
 };
 
-volatile enum sensors current_sensor = potentiometer;
-
-void uart_init() {
-	//Enable transmitter and receiver on USART0
-	UCSR0B |= (1 << TXEN0) | (1 << RXEN0);
-	//Keep defaults : async with no parity and 1 stop bit
-	//Set character size to 8 bits
-	UCSR0C |= (1 << UCSZ00) | (1 << UCSZ00);
-	//Set baud rate to UART_BAUDRATE
-	UBRR0 = (F_CPU / 8 / UART_BAUDRATE - 1) / 2;
-}
-
-void uart_tx(char c) {
-	//Wait for USART to be ready to transmit
-	while (!(UCSR0A & (1 << UDRE0))) {}
-	//Transmit character
-	UDR0 = c;
-}
-
-char uart_rx() {
-	//Wait for USART0 to have received something
-	while (!(UCSR0A & (1 << RXC0))) {}
-	//Return received character
-	return (UDR0);
-}
-
-void uart_printstr(const char *str) {
-	for (int i = 0; str[i]; i++) {
-		uart_tx(str[i]);
-	}
-}
-
-void uart_print_hex(uint8_t n) {
-	char *base = "0123456789ABCDEF";
-	uart_tx(base[n / 16]);
-	uart_tx(base[n % 16]);
-}
-
-void uart_print_dec(uint16_t n) {
-	char output[6];
-	output[5] = 0;
-	int i = 4;
-	while (i >= 0) {
-		output[i] = n % 10 + '0';
-		n /= 10;
-		if (n == 0)
-			break;
-		i--;
-	}
-	uart_printstr(&output[i]);
-}
-
-void uart_print_nl(const char *str) {
-	uart_printstr(str);
-	uart_printstr("\r\n");
-}
+//Sensors are on ADC0, ADC1 and ADC2, one scan every 20ms
+const adc_channel channels[] = {
+	{0, ADC_REF_AVCC, 0, 0},
+	{1, ADC_REF_AVCC, 0, 0},
+	{2, ADC_REF_AVCC, 0, 0}
+};
 
-void adc_init() {
-	//Set Vref to AVcc
-	ADMUX |= (1 << REFS0);
-	//Select RV1 (ADC0) (default)
-	//Enable auto trigger
-	ADCSRA |= (1 << ADATE);
-	//Enable interrupts
-	SREG |= (1 << SREG_I);
-	ADCSRA |= (1 << ADIE);
-	//ADC clock should be between 50kHz and 200kHz
-	//Set prescaler to 128 -> clock = 125kHz
-	ADCSRA |= (1 << ADPS2) | (1 << ADPS1)| (1 << ADPS0);
-	//Set trigger source to timer 1 compare B
-	ADCSRB |= (1 << ADTS2) | (1 << ADTS0);
-	//Enable ADC
-	ADCSRA |= (1 << ADEN);
-}
+enum prof_slots {
+	prof_sensors
+};
 
 void timer_init() {
 	//Set CTC mode
@@ -94,39 +36,41 @@ void timer_init() {
 	OCR1B = 1250;
 }
 
-ISR(ADC_vect) {
-	//Print measurement
-	uart_print_dec(ADC);
-	//Print separation and select next sensor
-	switch (current_sensor) {
-	case potentiometer:
-		uart_printstr(", ");
-		current_sensor = photoresistor;
-		ADMUX |= (1 << MUX0);
-		//Trigger new conversion
-		ADCSRA |= (1 << ADSC);
-		break;
-	case photoresistor:
-		uart_printstr(", ");
-		current_sensor = thermistor;
-		ADMUX &= ~(1 << MUX0);
-		ADMUX |= (1 << MUX1);
-		//Trigger new conversion
-		ADCSRA |= (1 << ADSC);
-		break;
-	case thermistor:
-		uart_print_nl("");
-		current_sensor = potentiometer;
-		ADMUX &= ~((1 << MUX0) | (1 << MUX1));
-		break;
+//Print the measurements of the last scan, profiled from the main context
+void print_sensors() {
+	PROF_MAIN_ENTER(prof_sensors);
+	for (enum sensors sensor = potentiometer; sensor <= thermistor; sensor++) {
+		adc_sample sample;
+		if (sensor != potentiometer)
+			uart_printstr(", ");
+		if (adc_scan_read(sensor, &sample))
+			uart_print_dec(sample.value);
 	}
-	//Clear timer1 interrupt flag
-	TIFR1 |= (1 << OCF1B);
+	uart_print_nl("");
+	PROF_MAIN_EXIT(prof_sensors);
 }
 
 int main() {
 	uart_init();
+#ifdef UART_BENCH
+	//Cycles to print a line of readings, blocking then through the ring buffer:
+	//make re CFLAGS=-DUART_BENCH
+	uart_bench();
+#endif
 	adc_init();
+	adc_scan_init(channels, sizeof channels / sizeof *channels, ADC_TRIGGER_TIMER1_COMPB);
 	timer_init();
-	while (1) {}
+#ifdef PROF
+	prof_init();
+	prof_name(prof_sensors, "sensors");
+#endif
+	while (1) {
+		//Sleep until a scan is done, the thermistor comes last
+		adc_scan_wait(thermistor);
+		print_sensors();
+#ifdef PROF
+		//Commands are answered after the next scan
+		prof_poll();
+#endif
+	}
 }
@@ -1,139 +1,29 @@
 #include <avr/io.h>
 #include <util/delay.h>
 #include <avr/interrupt.h>
-#include <util/twi.h>
-
-#define TWI_BAUDRATE 100000ul
-#define IO_EXP_ADDR 0b01000000
-
-volatile uint16_t display_n = 0;
-volatile uint8_t digit_position = 0;
-
-void uart_init() {
-	//Enable transmitter on USART0
-	UCSR0B |= (1 << TXEN0);
-	//Keep defaults : async with no parity and 1 stop bit
-	//Set character size to 8 bits
-	UCSR0C |= (1 << UCSZ00) | (1 << UCSZ00);
-	//Set baud rate to UART_BAUDRATE
-	UBRR0 = (F_CPU / 8 / UART_BAUDRATE - 1) / 2;
-}
-
-void uart_tx(char c) {
-	//Wait for USART to be ready to transmit
-	while (!(UCSR0A & (1 << UDRE0))) {}
-	//Transmit character
-	UDR0 = c;
-}
-
-void uart_printstr(const char *str) {
-	for (int i = 0; str[i]; i++) {
-		uart_tx(str[i]);
-	}
-}
-
-void uart_print_nl(const char *str) {
-	uart_printstr(str);
-	uart_printstr("\r\n");
-}
-
-void uart_print_hex(uint8_t n) {
-	char *base = "0123456789ABCDEF";
-	uart_tx(base[n / 16]);
-	uart_tx(base[n % 16]);
-}
-
-void uart_print_dec(uint16_t n) {
-	char output[6];
-	output[5] = 0;
-	int i = 4;
-	while (i >= 0) {
-		output[i] = n % 10 + '0';
-		n /= 10;
-		if (n == 0)
-			break;
-		i--;
-	}
-	uart_printstr(&output[i]);
-}
-
-void i2c_init() {
-	//Set baudrate (with prescaler set to 1x)
-	TWBR = (uint8_t) (F_CPU / TWI_BAUDRATE / 2 - 8);
-	//Enable TWI module
-	TWCR |= (1 << TWEN);
-}
-
-int wait_i2c_ready() {
-	while ((TWCR & (1 << TWINT)) == 0) {}
-	return (TW_STATUS);
-}
-
-void i2c_start() {
-	//Set start bit and clear TWINT bit (notifies module to continue)
-	TWCR |= (1 << TWSTA) | (1 << TWINT);
-}
-
-void i2c_stop() {
-	wait_i2c_ready();
-	//Set stop bit
-	TWCR |= (1 << TWSTO);
-	//Clear TWINT bit (notifies module to continue)
-	TWCR |= (1 << TWINT);
-}
-
-void i2c_write(uint8_t data) {
-	wait_i2c_ready();
-	//Clear start flag while not "clearing" TWINT
-	TWCR &= ~((1 << TWSTA) | (1 << TWINT));
-	TWDR = data;
-	//Clear interrupt
-	TWCR |= (1 << TWINT);
-}
-
-uint8_t i2c_read() {
-	wait_i2c_ready();
-	return (TWDR);
-}
-
-void i2c_ack() {
-	TWCR |= (1 << TWEA) | (1 << TWINT);
-}
-
-void i2c_nack() {
-	TWCR &= ~((1 << TWEA) | (1 << TWINT));
-	TWCR |= (1 << TWINT);
-}
+#include "adc.h"
+#include "filter.h"
+#include "i2c.h"
+#include "idle.h"
+#include "pca9555.h"
+#include "seg7.h"
+#include "uart.h"
+
+const i2c_profile i2c_profiles[] = {
+	I2C_PROFILE(PCA9555_ADDR, I2C_FAST_BAUDRATE)
+};
+
+uint16_t last_adc_value = 0xFFFF;
+//Spikes are removed, then noise smoothed (~400ms time constant at 10Hz)
+filter_median adc_median = FILTER_MEDIAN(5);
+filter_ema adc_ema = FILTER_EMA(2);
+//The last digit only changes when the value leaves a 2 LSB band
+filter_hysteresis display_hysteresis = FILTER_HYSTERESIS(2, 1023);
+volatile _Bool sample_due = 0;
 
 void io_init() {
-	i2c_start();
-	//Address io expander
-	i2c_write(IO_EXP_ADDR | TW_WRITE);
-	//Send configuration command
-	i2c_write(0x06);
-	//Set IO0_0 to input
-	i2c_write(1);
-	//Set IO1 to output
-	i2c_write(0);
-	i2c_stop();
-}
-
-void adc_init() {
-	//Set Vref to AVcc
-	ADMUX |= (1 << REFS0);
-	//Select RV1 (ADC0) (default)
-	//Enable auto trigger
-	ADCSRA |= (1 << ADATE);
-	//Enable interrupts
-	SREG |= (1 << SREG_I);
-	ADCSRA |= (1 << ADIE);
-	//ADC clock should be between 50kHz and 200kHz
-	//Set prescaler to 128 -> clock = 125kHz
-	ADCSRA |= (1 << ADPS2) | (1 << ADPS1)| (1 << ADPS0);
-	//Set trigger source to timer 1 compare B
-	ADCSRB |= (1 << ADTS2) | (1 << ADTS0);
-	//Enable ADC
-	ADCSRA |= (1 << ADEN);
+	//Set IO0_0 to input and IO1 to output
+	pca9555_write(PCA9555_CONFIG, 1, 0);
 }
 
 void display_timer_init() {
@@ -146,79 +36,44 @@ void display_timer_init() {
 
 void adc_timer_init() {
 	//Set timer 1 to CTC mode with OCR1A as top and 256x prescaler
-	//This will trigger ADC at intervals of 100ms
+	//This will wake the main loop at intervals of 100ms
 	TCCR1B |= (1 << WGM12) | (1 << CS12);
 	OCR1A = 6250;
-	OCR1B = 6250;
+	TIMSK1 |= (1 << OCIE1A);
 }
 
-uint8_t get_segment_digit(uint8_t n) {
-	switch (n % 10) {
-	case 0:
-		return (0b00111111);
-	case 1:
-		return (0b00000110);
-	case 2:
-		return (0b01011011);
-	case 3:
-		return (0b01001111);
-	case 4:
-		return (0b01100110);
-	case 5:
-		return (0b01101101);
-	case 6:
-		return (0b01111101);
-	case 7:
-		return (0b00000111);
-	case 8:
-		return (0b01111111);
-	case 9:
-		return (0b01101111);
-	}
+ISR(TIMER0_OVF_vect) {
+	//Display next digit of the frame on 7 segment display
+	seg7_refresh_async(255);
 }
 
-ISR(TIMER0_OVF_vect) {
-	//Display current digit on 7 segment display
-	//We first need to wipe the display to prevent ghosting
-	uint16_t digit = display_n;
-	for (int i = 0; i < digit_position; i++) {
-		digit /= 10;
-	}
-	i2c_start();
-	//Address io expander
-	i2c_write(IO_EXP_ADDR | TW_WRITE);
-	//Send output port 0 command and wipe
-	i2c_write(0x02);
-	i2c_write(255);
-	i2c_write(0);
-	wait_i2c_ready();
-	i2c_start();
-	i2c_write(IO_EXP_ADDR | TW_WRITE);
-	//Restart and display current digit
-	i2c_write(0x02);
-	//Set IO0 low on current digit CC
-	i2c_write((uint8_t) ~(1 << (7 - digit_position)));
-	//Set IO1 to display digit
-	i2c_write(get_segment_digit(digit % 10));
-	i2c_stop();
-	digit_position++;
-	if (digit_position == 4)
-		digit_position = 0;
+ISR(TIMER1_COMPA_vect) {
+	sample_due = 1;
 }
 
-ISR(ADC_vect) {
-	//Update display value
-	display_n = ADC;
-	//Clear timer1 interrupt flag
-	TIFR1 |= (1 << OCF1B);
+void update_value() {
+	//Update display value, only rendered when it changed
+	//Converted with the CPU asleep, the display pauses for the conversion
+	uint16_t value = adc_sleep_conv();
+	value = filter_ema_step(&adc_ema, filter_median_step(&adc_median, value));
+	value = filter_hysteresis_step(&display_hysteresis, value);
+	if (value != last_adc_value) {
+		seg7_render_dec(value, 1);
+		last_adc_value = value;
+	}
 }
 
 int main() {
 	uart_init();
-	i2c_init();
+	i2c_init(i2c_profiles, I2C_PROFILE_COUNT(i2c_profiles));
 	io_init();
 	display_timer_init();
 	adc_init();
 	adc_timer_init();
-	while (1) {}
+	while (1) {
+		//Sleep until timer 1 ends the 100ms period
+		idle_wait(&sample_due, SLEEP_MODE_IDLE);
+		sample_due = 0;
+		update_value();
+	}
 }
@@ -0,0 +1,35 @@
+#include <avr/io.h>
+#include "adc.h"
+
+void adc_init() {
+	//Set Vref to AVcc
+	ADMUX |= (1 << REFS0);
+	//Select RV1 (ADC0) (default)
+	//ADC clock should be between 50kHz and 200kHz
+	//Set prescaler to 128 -> clock = 125kHz
+	ADCSRA |= (1 << ADPS2) | (1 << ADPS1) | (1 << ADPS0);
+	//Enable ADC
+	ADCSRA |= (1 << ADEN);
+}
+
+//Start a conversion on every trigger event and interrupt when it is done
+void adc_auto_trigger(uint8_t source) {
+	//Set trigger source
+	ADCSRB = (ADCSRB & ~((1 << ADTS2) | (1 << ADTS1) | (1 << ADTS0))) | source;
+	//Enable auto trigger
+	ADCSRA |= (1 << ADATE);
+	//Enable interrupts
+	SREG |= (1 << SREG_I);
+	ADCSRA |= (1 << ADIE);
+}
+
+//Select input channel, reference and adjust bits are kept
+void adc_select(uint8_t mux) {
+	ADMUX = (ADMUX & ~((1 << MUX3) | (1 << MUX2) | (1 << MUX1) | (1 << MUX0))) | mux;
+}
+
+uint16_t adc_get_conv() {
+	ADCSRA |= (1 << ADSC);
+	while (ADCSRA & (1 << ADSC)) {}
+	return (ADC);
+}
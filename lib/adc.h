@@ -0,0 +1,19 @@
+#ifndef ADC_H
+#define ADC_H
+
+#include <stdint.h>
+#include <avr/io.h>
+
+//Auto trigger sources (ADTS bits of ADCSRB)
+#define ADC_TRIGGER_TIMER0_COMPA ((1 << ADTS1) | (1 << ADTS0))
+#define ADC_TRIGGER_TIMER1_COMPB ((1 << ADTS2) | (1 << ADTS0))
+#define ADC_TRIGGER_TIMER1_CAPT ((1 << ADTS2) | (1 << ADTS1) | (1 << ADTS0))
+
+void adc_init();
+void adc_auto_trigger(uint8_t source);
+void adc_select(uint8_t mux);
+uint16_t adc_get_conv();
+uint16_t adc_sleep_conv();
+uint16_t adc_oversample(uint8_t extra_bits);
+
+#endif
@@ -0,0 +1,154 @@
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <util/atomic.h>
+#include "adc.h"
+#include "adc_scan.h"
+#include "idle.h"
+
+//Every trigger starts a scan: ADC_vect stores each result in the ring of its
+//table entry and starts the next conversion by hand until the end of the table
+
+#define ADC_SCAN_BUFFER_MASK (ADC_SCAN_BUFFER_SIZE - 1)
+
+#if (ADC_SCAN_BUFFER_SIZE & ADC_SCAN_BUFFER_MASK) || ADC_SCAN_BUFFER_SIZE > 256
+# error "ADC_SCAN_BUFFER_SIZE must be a power of 2 no larger than 256"
+#endif
+
+static const adc_channel *table = 0;
+static uint8_t table_size = 0;
+static uint8_t trigger_source = 0;
+static uint8_t current = 0;
+static uint8_t to_discard = 0;
+static uint16_t scan = 0;
+
+//Single producer (ADC_vect) single consumer ring per channel, each side only
+//writes its own index
+static volatile adc_sample rings[ADC_SCAN_CHANNELS][ADC_SCAN_BUFFER_SIZE];
+static volatile uint8_t heads[ADC_SCAN_CHANNELS];
+static volatile uint8_t tails[ADC_SCAN_CHANNELS];
+static volatile uint16_t overflows = 0;
+
+static uint8_t admux_of(const adc_channel *channel) {
+	uint8_t admux = channel->ref | channel->mux;
+	if (channel->left_adjust)
+		admux |= (1 << ADLAR);
+	return (admux);
+}
+
+//The new settings apply from the next conversion
+static void select(uint8_t entry) {
+	uint8_t admux = admux_of(&table[entry]);
+	to_discard = admux != ADMUX ? table[entry].discard : 0;
+	ADMUX = admux;
+	current = entry;
+}
+
+//trigger is one of ADC_TRIGGER_*, the table must outlive the scan. Returns 0
+//and starts nothing if count is 0 or more than ADC_SCAN_CHANNELS
+uint8_t adc_scan_init(const adc_channel *channels, uint8_t count, uint8_t trigger) {
+	if (count == 0 || count > ADC_SCAN_CHANNELS)
+		return (0);
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		table = channels;
+		table_size = count;
+		trigger_source = trigger;
+		for (uint8_t i = 0; i < ADC_SCAN_CHANNELS; i++) {
+			heads[i] = 0;
+			tails[i] = 0;
+		}
+		select(0);
+	}
+	adc_auto_trigger(trigger);
+	return (1);
+}
+
+//The trigger only starts a conversion on a rising edge of its flag, nothing
+//else clears it when its interrupt is off
+static void clear_trigger() {
+	switch (trigger_source) {
+	case ADC_TRIGGER_TIMER0_COMPA:
+		TIFR0 |= (1 << OCF0A);
+		break;
+	case ADC_TRIGGER_TIMER1_COMPB:
+		TIFR1 |= (1 << OCF1B);
+		break;
+	case ADC_TRIGGER_TIMER1_CAPT:
+		TIFR1 |= (1 << ICF1);
+		break;
+	}
+}
+
+static void push(uint8_t entry, uint16_t value) {
+	uint8_t next = (heads[entry] + 1) & ADC_SCAN_BUFFER_MASK;
+	if (next == tails[entry]) {
+		overflows++;
+		return;
+	}
+	rings[entry][heads[entry]].value = value;
+	rings[entry][heads[entry]].scan = scan;
+	heads[entry] = next;
+}
+
+ISR(ADC_vect) {
+	uint16_t value = ADC;
+	if (to_discard) {
+		to_discard--;
+		ADCSRA |= (1 << ADSC);
+		return;
+	}
+	push(current, value);
+	if (current + 1 < table_size) {
+		select(current + 1);
+		ADCSRA |= (1 << ADSC);
+		return;
+	}
+	//End of the scan, wait for the next trigger on the first entry
+	scan++;
+	select(0);
+	clear_trigger();
+}
+
+//Takes the oldest sample of table entry channel, returns 0 if there is none
+uint8_t adc_scan_read(uint8_t channel, adc_sample *sample) {
+	uint8_t tail = tails[channel];
+	if (heads[channel] == tail)
+		return (0);
+	sample->value = rings[channel][tail].value;
+	sample->scan = rings[channel][tail].scan;
+	tails[channel] = (tail + 1) & ADC_SCAN_BUFFER_MASK;
+	return (1);
+}
+
+//Copies the newest sample and drops the older ones, returns 0 if there is none
+uint8_t adc_scan_latest(uint8_t channel, adc_sample *sample) {
+	uint8_t head = heads[channel];
+	if (head == tails[channel])
+		return (0);
+	uint8_t last = (head - 1) & ADC_SCAN_BUFFER_MASK;
+	sample->value = rings[channel][last].value;
+	sample->scan = rings[channel][last].scan;
+	tails[channel] = head;
+	return (1);
+}
+
+//Sleeps in idle mode until table entry channel has a sample. Noise reduction
+//sleep would stop the timer that triggers the scans
+void adc_scan_wait(uint8_t channel) {
+	while (1) {
+		cli();
+		if (heads[channel] != tails[channel]) {
+			sei();
+			return;
+		}
+		idle_sleep(SLEEP_MODE_IDLE);
+	}
+}
+
+//Samples dropped because a ring was full
+uint16_t adc_scan_get_overflows() {
+	uint16_t n;
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		n = overflows;
+	}
+	return (n);
+}
@@ -0,0 +1,47 @@
+#ifndef ADC_SCAN_H
+#define ADC_SCAN_H
+
+#include <stdint.h>
+#include <avr/io.h>
+
+//Largest scan table
+#ifndef ADC_SCAN_CHANNELS
+# define ADC_SCAN_CHANNELS 4
+#endif
+
+//Samples kept per channel, must be a power of 2 no larger than 256
+#ifndef ADC_SCAN_BUFFER_SIZE
+# define ADC_SCAN_BUFFER_SIZE 8
+#endif
+
+//Reference selection (REFS bits of ADMUX)
+#define ADC_REF_AVCC (1 << REFS0)
+#define ADC_REF_1V1 ((1 << REFS1) | (1 << REFS0))
+
+//Internal temperature sensor (needs ADC_REF_1V1)
+#define ADC_MUX_TEMP (1 << MUX3)
+
+typedef struct adc_channel_s {
+	//MUX bits of ADMUX, 0-7 for ADC0-ADC7
+	uint8_t mux;
+	uint8_t ref;
+	_Bool left_adjust;
+	//Conversions thrown away after switching to this channel while the input
+	//settles, not done when the previous entry has the same settings
+	uint8_t discard;
+} adc_channel;
+
+typedef struct adc_sample_s {
+	//ADC register, left adjusted if the channel asks for it
+	uint16_t value;
+	//Number of the scan it was taken in (one scan per trigger)
+	uint16_t scan;
+} adc_sample;
+
+uint8_t adc_scan_init(const adc_channel *channels, uint8_t count, uint8_t trigger);
+uint8_t adc_scan_read(uint8_t channel, adc_sample *sample);
+uint8_t adc_scan_latest(uint8_t channel, adc_sample *sample);
+void adc_scan_wait(uint8_t channel);
+uint16_t adc_scan_get_overflows();
+
+#endif
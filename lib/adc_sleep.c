@@ -0,0 +1,49 @@
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include "adc.h"
+#include "idle.h"
+#include "uart.h"
+
+//The interrupt only wakes the CPU
+EMPTY_INTERRUPT(ADC_vect);
+
+//Stopping the I/O clock would garble a transfer in progress: a character the
+//UART is still sending, a transaction of the I2C queue (TWIE is set until it
+//ends, TWSTO while its stop is sent) or an SPI frame sent by interrupt (SPIE)
+static uint8_t io_busy() {
+	return (!uart_tx_idle()
+		|| (TWCR & ((1 << TWIE) | (1 << TWSTO)))
+		|| (SPCR & (1 << SPIE)));
+}
+
+//Converts with the CPU and I/O clocks stopped (ADC noise reduction mode), so
+//the CPU and the timers add no noise. Timers are frozen for the ~104us of the
+//conversion, PWM outputs (rgb.c) hold their level meanwhile and the period
+//they are in is stretched. While a transfer is in progress the conversion is
+//polled instead. Auto trigger must be off and no other ADC_vect defined, other
+//interrupts may wake the CPU early so it goes back to sleep
+uint16_t adc_sleep_conv() {
+	ADCSRA |= (1 << ADIE);
+	//Entering the mode starts the conversion
+	do {
+		cli();
+		//Checked with interrupts off so no ISR can start a transfer before we sleep
+		if (io_busy()) {
+			sei();
+			return (adc_get_conv());
+		}
+		idle_sleep(SLEEP_MODE_ADC);
+	} while (ADCSRA & (1 << ADSC));
+	return (ADC);
+}
+
+//Adds extra_bits of resolution to a right adjusted result: sums 4^extra_bits
+//conversions and drops extra_bits bits (2 gives 12 bits from 16 samples, at
+//most 3). This only works if the input moves by about 1 LSB between samples,
+//otherwise it is just an average
+uint16_t adc_oversample(uint8_t extra_bits) {
+	uint16_t sum = 0;
+	for (uint8_t n = 1 << (2 * extra_bits); n; n--)
+		sum += adc_sleep_conv();
+	return (sum >> extra_bits);
+}
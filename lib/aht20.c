@@ -0,0 +1,14 @@
+#include "aht20.h"
+
+//The datasheet formulas are RH = raw / 2^20 * 100 and T = raw / 2^20 * 200 - 50
+//In hundredths: raw * 10000 / 2^20 = raw * 625 / 2^16 and
+//raw * 20000 / 2^20 = raw * 1250 / 2^16 (raw * 2250 / 2^16 - 5800 in F), all
+//products fit in 32 bits for a 20 bit raw value. Half of 2^16 is added to
+//round to nearest
+void aht20_decode(const uint8_t *data, aht20_reading *reading) {
+	uint32_t raw_humidity = ((uint32_t) data[1] << 12) | ((uint16_t) data[2] << 4) | (data[3] >> 4);
+	uint32_t raw_temp = ((uint32_t) (data[3] & 0x0F) << 16) | ((uint16_t) data[4] << 8) | data[5];
+	reading->humidity = (raw_humidity * 625 + (1ul << 15)) >> 16;
+	reading->temp_c = (int16_t) ((raw_temp * 1250 + (1ul << 15)) >> 16) - 5000;
+	reading->temp_f = (int16_t) ((raw_temp * 2250 + (1ul << 15)) >> 16) - 5800;
+}
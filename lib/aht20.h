@@ -0,0 +1,39 @@
+#ifndef AHT20_H
+#define AHT20_H
+
+#include <stdint.h>
+
+#define AHT20_ADDR 0b01110000
+
+//Status byte bits
+#define AHT20_BUSY (1 << 7)
+#define AHT20_CALIBRATED (1 << 3)
+
+//Size of a measurement: status then 20 bits of humidity and 20 of temperature
+#define AHT20_DATA_SIZE 6
+
+//Background sampler (aht20_sampler.c): period of aht20_sampler_tick calls and
+//time between measurements. The datasheet advises at most one measurement
+//every 2s to keep self-heating low
+#ifndef AHT20_TICK_MS
+# define AHT20_TICK_MS 16
+#endif
+#ifndef AHT20_PERIOD_MS
+# define AHT20_PERIOD_MS 2000
+#endif
+
+//Fixed point values, in hundredths of a degree and of a percent
+typedef struct aht20_reading_s {
+	int16_t temp_c;
+	int16_t temp_f;
+	uint16_t humidity;
+	//Sampler tick at which the measurement was read
+	uint16_t time;
+} aht20_reading;
+
+void aht20_decode(const uint8_t *data, aht20_reading *reading);
+void aht20_sampler_tick();
+uint8_t aht20_get(aht20_reading *reading);
+uint16_t aht20_ticks();
+
+#endif
@@ -0,0 +1,96 @@
+#include <avr/io.h>
+#include <util/atomic.h>
+#include "aht20.h"
+#include "i2c.h"
+
+//One measurement is triggered every AHT20_PERIOD_MS and read back 80ms later
+//through the transaction queue, every consumer reads the cached result
+
+//Measurement takes 80ms
+#define MEASURE_TICKS ((80 + AHT20_TICK_MS - 1) / AHT20_TICK_MS)
+#define PERIOD_TICKS (AHT20_PERIOD_MS / AHT20_TICK_MS)
+
+enum sampler_state_e {
+	sampler_idle,
+	sampler_triggered,
+	sampler_reading
+};
+
+static volatile enum sampler_state_e state = sampler_idle;
+//Start the first measurement on the first tick
+static volatile uint16_t state_ticks = PERIOD_TICKS;
+static volatile uint16_t ticks = 0;
+static aht20_reading cache;
+static volatile _Bool cache_valid = 0;
+
+static void trigger_done(i2c_xfer *xfer);
+static void read_done(i2c_xfer *xfer);
+
+static const uint8_t trigger_cmd[3] = {0xAC, 0x33, 0x00};
+static uint8_t read_buf[AHT20_DATA_SIZE];
+static i2c_xfer measure_xfer = {AHT20_ADDR, trigger_cmd, 3, 0, 0, trigger_done, i2c_xfer_idle};
+static i2c_xfer result_xfer = {AHT20_ADDR, 0, 0, read_buf, AHT20_DATA_SIZE, read_done, i2c_xfer_idle};
+
+//Callbacks run in TWI_vect
+static void trigger_done(i2c_xfer *xfer) {
+	//Sensor missing or busy, try again next period
+	if (xfer->status != i2c_xfer_done)
+		state = sampler_idle;
+}
+
+static void read_done(i2c_xfer *xfer) {
+	if (xfer->status != i2c_xfer_done) {
+		state = sampler_idle;
+		return;
+	}
+	//Not ready yet, read again on the next tick
+	if (read_buf[0] & AHT20_BUSY) {
+		state = sampler_triggered;
+		state_ticks = MEASURE_TICKS;
+		return;
+	}
+	aht20_decode(read_buf, &cache);
+	cache.time = ticks;
+	cache_valid = 1;
+	state = sampler_idle;
+}
+
+//Call every AHT20_TICK_MS, from an interrupt or the main loop
+void aht20_sampler_tick() {
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		ticks++;
+		state_ticks++;
+		switch (state) {
+		case sampler_idle:
+			if (state_ticks >= PERIOD_TICKS && i2c_queue(&measure_xfer)) {
+				state = sampler_triggered;
+				state_ticks = 0;
+			}
+			break;
+		case sampler_triggered:
+			if (state_ticks >= MEASURE_TICKS && i2c_queue(&result_xfer))
+				state = sampler_reading;
+			break;
+		case sampler_reading:
+			break;
+		}
+	}
+}
+
+//Copies the last measurement, returns 0 if there is none yet
+uint8_t aht20_get(aht20_reading *reading) {
+	uint8_t valid;
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		valid = cache_valid;
+		*reading = cache;
+	}
+	return (valid);
+}
+
+uint16_t aht20_ticks() {
+	uint16_t n;
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		n = ticks;
+	}
+	return (n);
+}
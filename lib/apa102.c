@@ -0,0 +1,198 @@
+#include <avr/io.h>
+#include <util/atomic.h>
+#include "spi.h"
+#include "apa102.h"
+#include "colour.h"
+
+const uint16_t apa102_led_count = APA102_LED_COUNT;
+
+#ifdef APA102_SINGLE_BUFFER
+# define BUFFER_COUNT 1
+#else
+# define BUFFER_COUNT 2
+#endif
+
+//Producers draw in the back buffer while the SPI interrupt streams the front
+//one. A commit swaps the two pointers, straight away when the chain is idle or
+//at the end of the frame being sent. With a single buffer both are the same
+//and nothing is swapped. Every LED starts off with a valid frame header
+static volatile led_setting buffers[BUFFER_COUNT][APA102_LED_COUNT] = {
+	[0 ... BUFFER_COUNT - 1] = {
+		[0 ... APA102_LED_COUNT - 1] = {APA102_BRIGHTNESS(0), 0, 0, 0}
+	}
+};
+static volatile led_setting *volatile back = buffers[0];
+static volatile led_setting *volatile front = buffers[BUFFER_COUNT - 1];
+
+static const uint8_t start_frame[4] = {0, 0, 0, 0};
+static const uint8_t end_frame[APA102_END_SIZE] = {
+	[0 ... APA102_END_SIZE - 1] = 255
+};
+
+static volatile _Bool sending = 0;
+//Committed while a frame was being sent, swapped in at its end
+static volatile _Bool pending = 0;
+//The back buffer still holds the frame before the last commit
+static volatile _Bool stale = 0;
+//Draws in progress, the back buffer is not swapped out under them
+static volatile uint8_t drawing = 0;
+//A polled frame ended on a commit, send_frame sends it next
+static volatile _Bool restart = 0;
+
+static void send_leds();
+
+//The three parts of the frame are chained from the SPI interrupt
+
+//Interrupts must be off. Nothing drawn since the last commit: the front buffer
+//already holds the frame and the back one an older state, send the front again.
+//The caller starts the frame with send_frame once interrupts are restored, so a
+//frame polled out at /2 or /4 doesn't keep them off
+static void commit() {
+#ifndef APA102_SINGLE_BUFFER
+	if (!stale) {
+		volatile led_setting *drawn = back;
+		back = front;
+		front = drawn;
+		stale = 1;
+	}
+#endif
+	pending = 0;
+	sending = 1;
+}
+
+//A polled frame is over before spi_send_async returns: a commit made at its end
+//is sent by this loop rather than from frame_done, so frames don't pile up on
+//the stack
+static void send_frame() {
+	do {
+		restart = 0;
+		spi_send_async(start_frame, 4, send_leds);
+	} while (restart);
+}
+
+static void frame_done() {
+	//Interrupts are only on at the end of a polled frame
+	_Bool polled = SREG & (1 << SREG_I);
+	_Bool start = 0;
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		sending = 0;
+		//A draw still in progress commits when it is done
+		if (pending && !drawing) {
+			commit();
+			start = 1;
+		}
+	}
+	if (start && polled)
+		restart = 1;
+	else if (start)
+		send_frame();
+}
+
+static void send_end() {
+	spi_send_async(end_frame, APA102_END_SIZE, frame_done);
+}
+
+static void send_leds() {
+	//Streamed straight from the front buffer, nobody writes it until the swap
+	spi_send_async((const uint8_t *) front, 4 * APA102_LED_COUNT, send_end);
+}
+
+//Commits the back buffer and sends it in the background, SPI must be
+//initialised. If a frame is being sent the commit is swapped in at its end so
+//a frame never mixes two states, LEDs drawn until then are part of it. Never
+//waits, safe from interrupts. With a single buffer it waits for the frame
+//being sent instead
+void apa102_show() {
+	_Bool start = 0;
+#ifdef APA102_SINGLE_BUFFER
+	spi_async_flush();
+#endif
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		if (sending) {
+			pending = 1;
+		} else {
+			commit();
+			start = 1;
+		}
+	}
+	if (start)
+		send_frame();
+}
+
+//Draws go through begin_draw/end_draw: the back buffer is brought up to date
+//with the last commit (~4 cycles per byte, interrupts on, the front buffer is
+//only read) and can't be swapped out half drawn. A single buffer is the one
+//being sent: the draw waits for the end of the frame rather than tear it
+static void begin_draw() {
+#ifdef APA102_SINGLE_BUFFER
+	spi_async_flush();
+#endif
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		drawing++;
+	}
+	if (stale) {
+		stale = 0;
+		for (uint16_t i = 0; i < APA102_LED_COUNT; i++)
+			back[i] = front[i];
+	}
+}
+
+static void end_draw() {
+	_Bool start = 0;
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		drawing--;
+		//The frame ended during the draw
+		if (!drawing && pending && !sending) {
+			commit();
+			start = 1;
+		}
+	}
+	if (start)
+		send_frame();
+}
+
+//Waits until the LEDs show the last apa102_show
+void apa102_flush() {
+	spi_async_flush();
+}
+
+//Commits the back buffer and waits for the end of its frame
+void apa102_update() {
+	apa102_show();
+	apa102_flush();
+}
+
+//Draws one LED in the back buffer, levels are gamma corrected
+void apa102_set_rgb(uint16_t led, uint8_t r, uint8_t g, uint8_t b) {
+	if (led >= APA102_LED_COUNT)
+		return;
+	begin_draw();
+	back[led].r = colour_gamma(r);
+	back[led].g = colour_gamma(g);
+	back[led].b = colour_gamma(b);
+	end_draw();
+}
+
+//Global brightness of one LED, n is 0 to 31
+void apa102_set_brightness(uint16_t led, uint8_t n) {
+	if (led >= APA102_LED_COUNT)
+		return;
+	begin_draw();
+	back[led].brightness = APA102_BRIGHTNESS(n);
+	end_draw();
+}
+
+//Draws every LED gamma corrected and commits
+void apa102_set_all(uint8_t r, uint8_t g, uint8_t b) {
+	r = colour_gamma(r);
+	g = colour_gamma(g);
+	b = colour_gamma(b);
+	begin_draw();
+	for (uint16_t i = 0; i < APA102_LED_COUNT; i++) {
+		back[i].r = r;
+		back[i].g = g;
+		back[i].b = b;
+	}
+	end_draw();
+	apa102_show();
+}
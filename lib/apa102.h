@@ -0,0 +1,63 @@
+#ifndef APA102_H
+#define APA102_H
+
+#include <stdint.h>
+
+//Length of the chain, D6, D7 and D8 on the board. It sizes the buffers in the
+//library: set it in CFLAGS when building an exercise, the library is rebuilt
+//with the same flags. apa102_led_count is the value the library was built with
+#ifndef APA102_LED_COUNT
+# define APA102_LED_COUNT 3
+#endif
+
+//The frame is kept twice, drawn in one buffer while the other is sent, as long
+//as both fit in half of the 2KB of RAM (128 LEDs). Longer chains, or builds
+//with APA102_SINGLE_BUFFER, keep it once: draws and apa102_show wait for the
+//frame being sent, up to 320 LEDs
+#if 2 * 4 * APA102_LED_COUNT > 1024 && !defined(APA102_SINGLE_BUFFER)
+# define APA102_SINGLE_BUFFER
+#endif
+
+#if 4 * APA102_LED_COUNT > 1280
+# error "APA102_LED_COUNT: the frame buffer must fit in 1280 bytes of RAM"
+#endif
+
+//Each LED delays the data by half a clock, the end frame gives the last one
+//its n/2 extra edges: ceil(n/16) bytes of 1s
+#define APA102_END_SIZE ((APA102_LED_COUNT + 15) / 16)
+//Start frame, one frame per LED and the end frame
+#define APA102_FRAME_SIZE (4 + 4 * APA102_LED_COUNT + APA102_END_SIZE)
+
+//Global brightness byte of an LED frame, n is 0 to 31
+#define APA102_BRIGHTNESS(n) (0b11100000 | (n))
+
+//Wire order: a committed buffer is sent as is, between the start and end frames.
+//Refresh time of the whole frame by SPI clock divider (/2 and /4 are polled
+//with interrupts on, the CPU is busy for the whole frame). Worked out from the bit rate and the
+//interrupt cost, NOT measured: run apa102_bench on the board for real figures.
+//Above 128 LEDs the frame is kept once, drawing waits for the last column:
+//         /2      /4      /8      /16     /32     /64     /128
+//3 LEDs   21us    38us    68us    136us   272us   544us   1.1ms
+//60 LEDs  310us   560us   990us   2.0ms   4.0ms   7.9ms   16ms
+//300 LEDs 1.5ms   2.8ms   4.9ms   9.8ms   20ms    39ms    78ms
+typedef struct led_data_s {
+	//APA102_BRIGHTNESS(n)
+	uint8_t brightness;
+	uint8_t b;
+	uint8_t g;
+	uint8_t r;
+} led_setting;
+
+//LEDs are drawn in a back buffer with apa102_set_rgb and apa102_set_brightness
+//then committed with apa102_show. Draw from one context (main or one ISR)
+extern const uint16_t apa102_led_count;
+
+void apa102_show();
+void apa102_flush();
+void apa102_update();
+void apa102_set_rgb(uint16_t led, uint8_t r, uint8_t g, uint8_t b);
+void apa102_set_brightness(uint16_t led, uint8_t n);
+void apa102_set_all(uint8_t r, uint8_t g, uint8_t b);
+void apa102_bench(uint8_t frames);
+
+#endif
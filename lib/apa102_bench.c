@@ -0,0 +1,67 @@
+#include <avr/io.h>
+#include "apa102.h"
+#include "spi.h"
+#include "uart.h"
+
+//Timer 1 with a 64x prescaler counts 4us
+#define US_PER_COUNT 4
+
+//uart_print_dec stops at 65535
+static void print_time(uint32_t us) {
+	if (us >= 10000) {
+		uart_print_dec(us / 1000);
+		uart_printstr("ms");
+	} else {
+		uart_print_dec(us);
+		uart_printstr("us");
+	}
+}
+
+static void print_line(uint8_t div, uint32_t total_us, uint8_t frames) {
+	uint32_t frame_us = total_us / frames;
+	//Time the bits alone take on the wire
+	uint32_t wire_us = (uint32_t) APA102_FRAME_SIZE * 8 * div / (F_CPU / 1000000);
+	uart_printstr("/");
+	uart_print_dec(div);
+	uart_printstr(": ");
+	print_time(frame_us);
+	uart_printstr(" (wire ");
+	print_time(wire_us);
+	uart_printstr(") ");
+	uart_print_dec(frame_us ? 1000000 / frame_us : 0);
+	uart_printstr(" fps");
+	//Faster than the wire means bytes were lost
+	if (frame_us + US_PER_COUNT < wire_us)
+		uart_printstr(" FAIL");
+	uart_print_nl("");
+}
+
+//Sends frames frames at every SPI divider and prints the time per frame and
+//the frame rate, to size a strip on the board. Uses timer 1, leaves the clock
+//as it found it
+void apa102_bench(uint8_t frames) {
+	uint8_t saved = spi_get_clock();
+	uart_printstr("APA102 bench: ");
+	uart_print_dec(APA102_LED_COUNT);
+	uart_printstr(" LEDs, ");
+	uart_print_dec(APA102_FRAME_SIZE);
+	uart_print_nl(" bytes per frame");
+	//Frames go through the SPI interrupt as they would in a program
+	SREG |= (1 << SREG_I);
+	TCCR1A = 0;
+	TCCR1B = (1 << CS11) | (1 << CS10);
+	for (uint16_t div = 2; div <= 128; div <<= 1) {
+		uint32_t total_us = 0;
+		spi_set_clock(div);
+		apa102_flush();
+		for (uint8_t i = 0; i < frames; i++) {
+			//Longest frame is ~82ms (320 LEDs at /128), timer 1 wraps at 262ms
+			TCNT1 = 0;
+			apa102_update();
+			total_us += (uint32_t) TCNT1 * US_PER_COUNT;
+		}
+		print_line(div, total_us, frames);
+	}
+	TCCR1B = 0;
+	spi_set_clock(saved);
+}
@@ -0,0 +1,117 @@
+#include <avr/io.h>
+#include "button.h"
+
+#define BUTTON_QUEUE_MASK (BUTTON_QUEUE_SIZE - 1)
+
+#if (BUTTON_QUEUE_SIZE & BUTTON_QUEUE_MASK) || BUTTON_QUEUE_SIZE > 256
+# error "BUTTON_QUEUE_SIZE must be a power of 2 no larger than 256"
+#endif
+
+//Low bits of the sample history that must agree before a change is accepted
+#define DEBOUNCE_MASK ((uint8_t) ((1 << BUTTON_DEBOUNCE_SAMPLES) - 1))
+#define LONG_TICKS (BUTTON_LONG_MS / BUTTON_TICK_MS)
+#define REPEAT_TICKS (BUTTON_REPEAT_MS / BUTTON_TICK_MS)
+
+typedef struct button_state_s {
+	//Last samples, most recent in bit 0, 1 when pressed
+	uint8_t history;
+	_Bool down;
+	uint16_t held_ticks;
+} button_state;
+
+static button_state buttons[button_count];
+static uint16_t (*read_expander)() = 0;
+static void (*event_handler)(button_event event) = 0;
+
+//Single producer (button_tick) single consumer (button_poll) queue, each side
+//only writes its own index so no interrupt masking is needed
+static volatile button_event queue[BUTTON_QUEUE_SIZE];
+static volatile uint8_t queue_head = 0;
+static volatile uint8_t queue_tail = 0;
+static volatile uint16_t overflows = 0;
+
+//expander_inputs (e.g. pca9555_inputs, may be 0) gives SW3, it must not touch
+//the bus as it is called from button_tick. With a handler events are passed
+//to it from button_tick instead of being queued
+void button_init(uint16_t (*expander_inputs)(), void (*handler)(button_event event)) {
+	read_expander = expander_inputs;
+	event_handler = handler;
+	//SW1 and SW2 are inputs with external pull-ups, low when pressed
+	DDRD &= ~((1 << DDD2) | (1 << DDD4));
+}
+
+static void emit(uint8_t button, uint8_t type) {
+	button_event event = {button, type};
+	if (event_handler) {
+		event_handler(event);
+		return;
+	}
+	uint8_t next = (queue_head + 1) & BUTTON_QUEUE_MASK;
+	if (next == queue_tail) {
+		overflows++;
+		return;
+	}
+	queue[queue_head].button = event.button;
+	queue[queue_head].type = event.type;
+	queue_head = next;
+}
+
+static void update(uint8_t button, _Bool pressed) {
+	button_state *b = &buttons[button];
+	b->history = (b->history << 1) | pressed;
+	if (!b->down && (b->history & DEBOUNCE_MASK) == DEBOUNCE_MASK) {
+		b->down = 1;
+		b->held_ticks = 0;
+		emit(button, button_press);
+	} else if (b->down && (b->history & DEBOUNCE_MASK) == 0) {
+		b->down = 0;
+		emit(button, button_release);
+	} else if (b->down) {
+		b->held_ticks++;
+		if (b->held_ticks == LONG_TICKS) {
+			emit(button, button_long_press);
+		} else if (b->held_ticks == LONG_TICKS + REPEAT_TICKS) {
+			emit(button, button_repeat);
+			b->held_ticks = LONG_TICKS;
+		}
+	}
+}
+
+//Call every BUTTON_TICK_MS from an interrupt (button_timer_init sets one up)
+void button_tick() {
+	uint8_t pind = PIND;
+	update(button_sw1, !(pind & (1 << PD2)));
+	update(button_sw2, !(pind & (1 << PD4)));
+	if (read_expander)
+		update(button_sw3, !(read_expander() & 1));
+}
+
+//Returns 0 when no event is waiting
+uint8_t button_poll(button_event *event) {
+	if (queue_head == queue_tail)
+		return (0);
+	event->button = queue[queue_tail].button;
+	event->type = queue[queue_tail].type;
+	queue_tail = (queue_tail + 1) & BUTTON_QUEUE_MASK;
+	return (1);
+}
+
+//1 when every button is released and stable and no event is waiting
+uint8_t button_idle() {
+	if (queue_head != queue_tail)
+		return (0);
+	for (uint8_t i = 0; i < button_count; i++) {
+		if (buttons[i].down || buttons[i].history)
+			return (0);
+	}
+	return (1);
+}
+
+//Debounced state
+uint8_t button_is_down(uint8_t button) {
+	return (buttons[button].down);
+}
+
+uint16_t button_get_overflows() {
+	return (overflows);
+}
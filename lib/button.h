@@ -0,0 +1,62 @@
+#ifndef BUTTON_H
+#define BUTTON_H
+
+#include <stdint.h>
+
+//Period of the button_tick calls
+#ifndef BUTTON_TICK_MS
+# define BUTTON_TICK_MS 1
+#endif
+
+//Number of identical samples for a button to change state (at most 8)
+#ifndef BUTTON_DEBOUNCE_SAMPLES
+# define BUTTON_DEBOUNCE_SAMPLES 4
+#endif
+
+//Hold time before a long press, then time between repeats
+#ifndef BUTTON_LONG_MS
+# define BUTTON_LONG_MS 800
+#endif
+#ifndef BUTTON_REPEAT_MS
+# define BUTTON_REPEAT_MS 200
+#endif
+
+//Size of the event queue, must be a power of 2 no larger than 256
+#ifndef BUTTON_QUEUE_SIZE
+# define BUTTON_QUEUE_SIZE 8
+#endif
+
+enum button_e {
+	//PD2
+	button_sw1,
+	//PD4
+	button_sw2,
+	//IO0_0 of the io expander
+	button_sw3,
+	button_count
+};
+
+enum button_event_type_e {
+	button_press,
+	button_release,
+	//Held for BUTTON_LONG_MS
+	button_long_press,
+	//Still held, every BUTTON_REPEAT_MS after the long press
+	button_repeat
+};
+
+typedef struct button_event_s {
+	uint8_t button;
+	uint8_t type;
+} button_event;
+
+void button_init(uint16_t (*expander_inputs)(), void (*handler)(button_event event));
+void button_timer_init();
+void button_tick();
+uint8_t button_poll(button_event *event);
+uint8_t button_idle();
+void button_sleep();
+uint8_t button_is_down(uint8_t button);
+uint16_t button_get_overflows();
+
+#endif
@@ -0,0 +1,25 @@
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include "button.h"
+#include "idle.h"
+
+//The pin change only wakes the CPU, the next button_tick sees the press
+EMPTY_INTERRUPT(PCINT2_vect);
+
+//Sleeps until the next interrupt. When the buttons are quiet nothing can happen
+//before a press, so it powers down (timers stopped) until SW1 or SW2 changes.
+//INT0 edges can't wake from power-down but pin changes can. SW3 on the io
+//expander does not wake it
+void button_sleep() {
+	cli();
+	if (!button_idle()) {
+		//Still debouncing, wait for the next tick
+		idle_sleep(SLEEP_MODE_IDLE);
+		return;
+	}
+	PCMSK2 |= (1 << PCINT18) | (1 << PCINT20);
+	PCICR |= (1 << PCIE2);
+	idle_sleep(SLEEP_MODE_PWR_DOWN);
+	PCICR &= ~(1 << PCIE2);
+	PCMSK2 &= ~((1 << PCINT18) | (1 << PCINT20));
+}
@@ -0,0 +1,22 @@
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include "button.h"
+
+#if BUTTON_TICK_MS != 1
+# error "button_timer_init ticks every 1ms, set BUTTON_TICK_MS to 1"
+#endif
+
+//Uses timer 2, for exercises that have no periodic interrupt of their own
+void button_timer_init() {
+	//Set timer 2 to CTC mode with OCR2A as top and 64x prescaler
+	//This will generate interrupts at intervals of 1ms (250kHz / 250)
+	TCCR2A = (1 << WGM21);
+	TCCR2B = (1 << CS22);
+	OCR2A = 249;
+	TIMSK2 |= (1 << OCIE2A);
+	SREG |= (1 << SREG_I);
+}
+
+ISR(TIMER2_COMPA_vect) {
+	button_tick();
+}
@@ -0,0 +1,159 @@
+#include <avr/pgmspace.h>
+#include "colour.h"
+
+//Colour wheel going red -> green -> blue -> red as pos goes from 0 to 255, one
+//triangle per channel (768 bytes of flash)
+static const rgb_colour wheel_table[256] PROGMEM = {
+	{255, 0, 0}, {252, 3, 0}, {249, 6, 0}, {246, 9, 0},
+	{243, 12, 0}, {240, 15, 0}, {237, 18, 0}, {234, 21, 0},
+	{231, 24, 0}, {228, 27, 0}, {225, 30, 0}, {222, 33, 0},
+	{219, 36, 0}, {216, 39, 0}, {213, 42, 0}, {210, 45, 0},
+	{207, 48, 0}, {204, 51, 0}, {201, 54, 0}, {198, 57, 0},
+	{195, 60, 0}, {192, 63, 0}, {189, 66, 0}, {186, 69, 0},
+	{183, 72, 0}, {180, 75, 0}, {177, 78, 0}, {174, 81, 0},
+	{171, 84, 0}, {168, 87, 0}, {165, 90, 0}, {162, 93, 0},
+	{159, 96, 0}, {156, 99, 0}, {153, 102, 0}, {150, 105, 0},
+	{147, 108, 0}, {144, 111, 0}, {141, 114, 0}, {138, 117, 0},
+	{135, 120, 0}, {132, 123, 0}, {129, 126, 0}, {126, 129, 0},
+	{123, 132, 0}, {120, 135, 0}, {117, 138, 0}, {114, 141, 0},
+	{111, 144, 0}, {108, 147, 0}, {105, 150, 0}, {102, 153, 0},
+	{99, 156, 0}, {96, 159, 0}, {93, 162, 0}, {90, 165, 0},
+	{87, 168, 0}, {84, 171, 0}, {81, 174, 0}, {78, 177, 0},
+	{75, 180, 0}, {72, 183, 0}, {69, 186, 0}, {66, 189, 0},
+	{63, 192, 0}, {60, 195, 0}, {57, 198, 0}, {54, 201, 0},
+	{51, 204, 0}, {48, 207, 0}, {45, 210, 0}, {42, 213, 0},
+	{39, 216, 0}, {36, 219, 0}, {33, 222, 0}, {30, 225, 0},
+	{27, 228, 0}, {24, 231, 0}, {21, 234, 0}, {18, 237, 0},
+	{15, 240, 0}, {12, 243, 0}, {9, 246, 0}, {6, 249, 0},
+	{3, 252, 0}, {0, 255, 0}, {0, 252, 3}, {0, 249, 6},
+	{0, 246, 9}, {0, 243, 12}, {0, 240, 15}, {0, 237, 18},
+	{0, 234, 21}, {0, 231, 24}, {0, 228, 27}, {0, 225, 30},
+	{0, 222, 33}, {0, 219, 36}, {0, 216, 39}, {0, 213, 42},
+	{0, 210, 45}, {0, 207, 48}, {0, 204, 51}, {0, 201, 54},
+	{0, 198, 57}, {0, 195, 60}, {0, 192, 63}, {0, 189, 66},
+	{0, 186, 69}, {0, 183, 72}, {0, 180, 75}, {0, 177, 78},
+	{0, 174, 81}, {0, 171, 84}, {0, 168, 87}, {0, 165, 90},
+	{0, 162, 93}, {0, 159, 96}, {0, 156, 99}, {0, 153, 102},
+	{0, 150, 105}, {0, 147, 108}, {0, 144, 111}, {0, 141, 114},
+	{0, 138, 117}, {0, 135, 120}, {0, 132, 123}, {0, 129, 126},
+	{0, 126, 129}, {0, 123, 132}, {0, 120, 135}, {0, 117, 138},
+	{0, 114, 141}, {0, 111, 144}, {0, 108, 147}, {0, 105, 150},
+	{0, 102, 153}, {0, 99, 156}, {0, 96, 159}, {0, 93, 162},
+	{0, 90, 165}, {0, 87, 168}, {0, 84, 171}, {0, 81, 174},
+	{0, 78, 177}, {0, 75, 180}, {0, 72, 183}, {0, 69, 186},
+	{0, 66, 189}, {0, 63, 192}, {0, 60, 195}, {0, 57, 198},
+	{0, 54, 201}, {0, 51, 204}, {0, 48, 207}, {0, 45, 210},
+	{0, 42, 213}, {0, 39, 216}, {0, 36, 219}, {0, 33, 222},
+	{0, 30, 225}, {0, 27, 228}, {0, 24, 231}, {0, 21, 234},
+	{0, 18, 237}, {0, 15, 240}, {0, 12, 243}, {0, 9, 246},
+	{0, 6, 249}, {0, 3, 252}, {0, 0, 255}, {3, 0, 252},
+	{6, 0, 249}, {9, 0, 246}, {12, 0, 243}, {15, 0, 240},
+	{18, 0, 237}, {21, 0, 234}, {24, 0, 231}, {27, 0, 228},
+	{30, 0, 225}, {33, 0, 222}, {36, 0, 219}, {39, 0, 216},
+	{42, 0, 213}, {45, 0, 210}, {48, 0, 207}, {51, 0, 204},
+	{54, 0, 201}, {57, 0, 198}, {60, 0, 195}, {63, 0, 192},
+	{66, 0, 189}, {69, 0, 186}, {72, 0, 183}, {75, 0, 180},
+	{78, 0, 177}, {81, 0, 174}, {84, 0, 171}, {87, 0, 168},
+	{90, 0, 165}, {93, 0, 162}, {96, 0, 159}, {99, 0, 156},
+	{102, 0, 153}, {105, 0, 150}, {108, 0, 147}, {111, 0, 144},
+	{114, 0, 141}, {117, 0, 138}, {120, 0, 135}, {123, 0, 132},
+	{126, 0, 129}, {129, 0, 126}, {132, 0, 123}, {135, 0, 120},
+	{138, 0, 117}, {141, 0, 114}, {144, 0, 111}, {147, 0, 108},
+	{150, 0, 105}, {153, 0, 102}, {156, 0, 99}, {159, 0, 96},
+	{162, 0, 93}, {165, 0, 90}, {168, 0, 87}, {171, 0, 84},
+	{174, 0, 81}, {177, 0, 78}, {180, 0, 75}, {183, 0, 72},
+	{186, 0, 69}, {189, 0, 66}, {192, 0, 63}, {195, 0, 60},
+	{198, 0, 57}, {201, 0, 54}, {204, 0, 51}, {207, 0, 48},
+	{210, 0, 45}, {213, 0, 42}, {216, 0, 39}, {219, 0, 36},
+	{222, 0, 33}, {225, 0, 30}, {228, 0, 27}, {231, 0, 24},
+	{234, 0, 21}, {237, 0, 18}, {240, 0, 15}, {243, 0, 12},
+	{246, 0, 9}, {249, 0, 6}, {252, 0, 3}, {255, 0, 0}
+};
+
+//round(255 * (v / 255)^2.2): the eye sees brightness in a power law, PWM
+//duties are linear
+static const uint8_t gamma_table[256] PROGMEM = {
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1,
+	1, 1, 1, 1, 1, 1, 1, 1, 1, 2, 2, 2, 2, 2, 2, 2,
+	3, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 6, 6, 6,
+	6, 7, 7, 7, 8, 8, 8, 9, 9, 9, 10, 10, 11, 11, 11, 12,
+	12, 13, 13, 13, 14, 14, 15, 15, 16, 16, 17, 17, 18, 18, 19, 19,
+	20, 20, 21, 22, 22, 23, 23, 24, 25, 25, 26, 26, 27, 28, 28, 29,
+	30, 30, 31, 32, 33, 33, 34, 35, 35, 36, 37, 38, 39, 39, 40, 41,
+	42, 43, 43, 44, 45, 46, 47, 48, 49, 49, 50, 51, 52, 53, 54, 55,
+	56, 57, 58, 59, 60, 61, 62, 63, 64, 65, 66, 67, 68, 69, 70, 71,
+	73, 74, 75, 76, 77, 78, 79, 81, 82, 83, 84, 85, 87, 88, 89, 90,
+	91, 93, 94, 95, 97, 98, 99, 100, 102, 103, 105, 106, 107, 109, 110, 111,
+	113, 114, 116, 117, 119, 120, 121, 123, 124, 126, 127, 129, 130, 132, 133, 135,
+	137, 138, 140, 141, 143, 145, 146, 148, 149, 151, 153, 154, 156, 158, 159, 161,
+	163, 165, 166, 168, 170, 172, 173, 175, 177, 179, 181, 182, 184, 186, 188, 190,
+	192, 194, 196, 197, 199, 201, 203, 205, 207, 209, 211, 213, 215, 217, 219, 221,
+	223, 225, 227, 229, 231, 234, 236, 238, 240, 242, 244, 246, 248, 251, 253, 255
+};
+
+//3 flash reads instead of branches and multiplies
+rgb_colour wheel(uint8_t pos) {
+	rgb_colour c;
+	c.r = pgm_read_byte(&wheel_table[pos].r);
+	c.g = pgm_read_byte(&wheel_table[pos].g);
+	c.b = pgm_read_byte(&wheel_table[pos].b);
+	return (c);
+}
+
+//Duty cycle that looks like brightness v
+uint8_t colour_gamma(uint8_t v) {
+	return (pgm_read_byte(&gamma_table[v]));
+}
+
+//Hue 0-255 around the same wheel as wheel (0 red, 85 green, 170 blue),
+//saturation and value 0-255. Six 43 step sectors, found with a multiply instead
+//of a division (~60 cycles)
+rgb_colour hsv(uint8_t h, uint8_t s, uint8_t v) {
+	rgb_colour c;
+	if (s == 0) {
+		c.r = v;
+		c.g = v;
+		c.b = v;
+		return (c);
+	}
+	uint16_t h6 = h * 6;
+	uint8_t sector = h6 >> 8;
+	//Position in the sector, 0-255
+	uint8_t f = h6;
+	uint8_t p = (v * (uint8_t) (255 - s)) >> 8;
+	uint8_t q = (v * (uint8_t) (255 - ((s * f) >> 8))) >> 8;
+	uint8_t t = (v * (uint8_t) (255 - ((s * (uint8_t) (255 - f)) >> 8))) >> 8;
+	switch (sector) {
+	case 0:
+		c.r = v;
+		c.g = t;
+		c.b = p;
+		break;
+	case 1:
+		c.r = q;
+		c.g = v;
+		c.b = p;
+		break;
+	case 2:
+		c.r = p;
+		c.g = v;
+		c.b = t;
+		break;
+	case 3:
+		c.r = p;
+		c.g = q;
+		c.b = v;
+		break;
+	case 4:
+		c.r = t;
+		c.g = p;
+		c.b = v;
+		break;
+	default:
+		c.r = v;
+		c.g = p;
+		c.b = q;
+		break;
+	}
+	return (c);
+}
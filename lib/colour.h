@@ -0,0 +1,16 @@
+#ifndef COLOUR_H
+#define COLOUR_H
+
+#include <stdint.h>
+
+typedef struct rgb_s {
+	uint8_t r;
+	uint8_t g;
+	uint8_t b;
+} rgb_colour;
+
+rgb_colour wheel(uint8_t pos);
+uint8_t colour_gamma(uint8_t v);
+rgb_colour hsv(uint8_t h, uint8_t s, uint8_t v);
+
+#endif
@@ -0,0 +1,69 @@
+#include "filter.h"
+
+uint16_t filter_ema_step(filter_ema *f, uint16_t in) {
+	if (!f->primed) {
+		f->acc = in << f->shift;
+		f->primed = 1;
+	}
+	f->acc += in - (f->acc >> f->shift);
+	//Not rounded: acc settles within 2^shift above in << shift from either side
+	return (f->acc >> f->shift);
+}
+
+static void sort2(uint16_t *a, uint16_t *b) {
+	if (*a > *b) {
+		uint16_t tmp = *a;
+		*a = *b;
+		*b = tmp;
+	}
+}
+
+static uint16_t median3(uint16_t a, uint16_t b, uint16_t c) {
+	sort2(&a, &b);
+	sort2(&b, &c);
+	sort2(&a, &b);
+	return (b);
+}
+
+//6 comparisons instead of a full sort: the lower bottom of two sorted pairs is
+//below three other samples so it can't be the median, drop it twice
+static uint16_t median5(const uint16_t *w) {
+	uint16_t a = w[0], b = w[1], c = w[2], d = w[3], e = w[4];
+	sort2(&a, &b);
+	sort2(&c, &d);
+	if (a < c) {
+		a = e;
+		sort2(&a, &b);
+	} else {
+		c = e;
+		sort2(&c, &d);
+	}
+	//The median is the lowest of the 3 samples left
+	if (a < c)
+		return (b < c ? b : c);
+	return (a < d ? a : d);
+}
+
+uint16_t filter_median_step(filter_median *f, uint16_t in) {
+	if (!f->primed) {
+		for (uint8_t i = 0; i < f->taps; i++)
+			f->window[i] = in;
+		f->primed = 1;
+	}
+	f->window[f->pos] = in;
+	f->pos++;
+	if (f->pos == f->taps)
+		f->pos = 0;
+	if (f->taps == 3)
+		return (median3(f->window[0], f->window[1], f->window[2]));
+	return (median5(f->window));
+}
+
+uint16_t filter_hysteresis_step(filter_hysteresis *f, uint16_t in) {
+	if (!f->primed || in == 0 || in >= f->max
+		|| in > f->value + f->band || in + f->band < f->value) {
+		f->value = in;
+		f->primed = 1;
+	}
+	return (f->value);
+}
@@ -0,0 +1,48 @@
+#ifndef FILTER_H
+#define FILTER_H
+
+#include <stdint.h>
+
+//Integer filters for one stream of samples (one instance per channel), the
+//first sample primes them so they start from it instead of 0. Costs are for
+//avr-gcc -O on the ATmega328P
+
+//Exponential moving average: out += (in - out) / 2^shift, ~40 cycles at
+//shift 3. Inputs of at most 16 - shift bits (10 bit ADC: shift up to 6)
+typedef struct filter_ema_s {
+	//Output << shift
+	uint16_t acc;
+	uint8_t shift;
+	_Bool primed;
+} filter_ema;
+
+#define FILTER_EMA(shift) {0, shift, 0}
+
+//Running median of the last 3 (~35 cycles) or 5 (~110 cycles) samples,
+//removes single sample spikes without smoothing edges
+typedef struct filter_median_s {
+	uint16_t window[5];
+	uint8_t taps;
+	uint8_t pos;
+	_Bool primed;
+} filter_median;
+
+#define FILTER_MEDIAN(taps) {{0}, taps, 0, 0}
+
+//Holds its output until the input moves more than band away, ~20 cycles.
+//Keeps a display from toggling between two values. 0 and max always pass
+//through so the ends of the range can still be reached
+typedef struct filter_hysteresis_s {
+	uint16_t value;
+	uint16_t band;
+	uint16_t max;
+	_Bool primed;
+} filter_hysteresis;
+
+#define FILTER_HYSTERESIS(band, max) {0, band, max, 0}
+
+uint16_t filter_ema_step(filter_ema *f, uint16_t in);
+uint16_t filter_median_step(filter_median *f, uint16_t in);
+uint16_t filter_hysteresis_step(filter_hysteresis *f, uint16_t in);
+
+#endif
@@ -0,0 +1,53 @@
+#include "fmt.h"
+
+//Each decimal digit is found by subtracting its power of ten, at most 9 times
+//per digit, instead of the libgcc division calls % 10 and / 10 compile to
+static const uint16_t dec_powers[4] = {10000, 1000, 100, 10};
+
+static const char hex_digits[16] = "0123456789ABCDEF";
+
+//Leading zeros are dropped then the result is padded on the left with pad up
+//to width characters (pad '0' gives fixed width output). buf must hold
+//width + 1 characters, and at least FMT_DEC_SIZE
+uint8_t fmt_dec(char *buf, uint16_t n, uint8_t width, char pad) {
+	char digits[5];
+	uint8_t len = 0;
+	for (uint8_t i = 0; i < 4; i++) {
+		char d = '0';
+		while (n >= dec_powers[i]) {
+			n -= dec_powers[i];
+			d++;
+		}
+		if (d != '0' || len)
+			digits[len++] = d;
+	}
+	digits[len++] = n + '0';
+	uint8_t out = 0;
+	while (out + len < width) {
+		buf[out++] = pad;
+	}
+	for (uint8_t i = 0; i < len; i++) {
+		buf[out++] = digits[i];
+	}
+	buf[out] = 0;
+	return (out);
+}
+
+//Writes the lowest digits (1 to 4) nibbles of n, most significant first
+uint8_t fmt_hex(char *buf, uint16_t n, uint8_t digits) {
+	for (int8_t i = digits - 1; i >= 0; i--) {
+		buf[i] = hex_digits[n & 0xF];
+		n >>= 4;
+	}
+	buf[digits] = 0;
+	return (digits);
+}
+
+uint8_t fmt_bin(char *buf, uint8_t n) {
+	for (int8_t i = 7; i >= 0; i--) {
+		buf[i] = (n & 1) + '0';
+		n >>= 1;
+	}
+	buf[8] = 0;
+	return (8);
+}
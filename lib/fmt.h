@@ -0,0 +1,16 @@
+#ifndef FMT_H
+#define FMT_H
+
+#include <stdint.h>
+
+//Number formatting into caller buffers, without any division. Every function
+//NUL terminates buf and returns the number of characters written
+
+//Size of a buffer large enough for any uint16_t in decimal
+#define FMT_DEC_SIZE 6
+
+uint8_t fmt_dec(char *buf, uint16_t n, uint8_t width, char pad);
+uint8_t fmt_hex(char *buf, uint16_t n, uint8_t digits);
+uint8_t fmt_bin(char *buf, uint8_t n);
+
+#endif
@@ -0,0 +1,87 @@
+#include <avr/io.h>
+#include "i2c.h"
+
+//TWCR is always written as a whole so no flag from the previous step
+//(TWSTA in particular) leaks into the next one
+
+void (*i2c_queue_hook)(_Bool acquire) = 0;
+
+static const i2c_profile *speed_profiles = 0;
+static uint8_t speed_profile_count = 0;
+static const i2c_profile *current_profile = 0;
+
+static void apply_profile(const i2c_profile *profile) {
+	if (profile) {
+		TWBR = profile->twbr;
+		TWSR = profile->twps;
+	} else {
+		TWBR = I2C_TWBR(TWI_BAUDRATE);
+		TWSR = I2C_TWPS(TWI_BAUDRATE);
+	}
+	current_profile = profile;
+}
+
+//Devices missing from profiles run at TWI_BAUDRATE, profiles must stay valid
+void i2c_init(const i2c_profile *profiles, uint8_t count) {
+	speed_profiles = profiles;
+	speed_profile_count = count;
+	apply_profile(0);
+	//Enable TWI module
+	TWCR |= (1 << TWEN);
+}
+
+//Only call between a start and the address byte (or with the bus idle)
+void i2c_set_speed(uint8_t addr) {
+	const i2c_profile *profile = 0;
+	for (uint8_t i = 0; i < speed_profile_count; i++) {
+		if (speed_profiles[i].addr == addr) {
+			profile = &speed_profiles[i];
+			break;
+		}
+	}
+	if (profile != current_profile)
+		apply_profile(profile);
+}
+
+uint8_t wait_i2c_ready() {
+	while ((TWCR & (1 << TWINT)) == 0) {}
+	return (TW_STATUS);
+}
+
+void i2c_start() {
+	if (i2c_queue_hook)
+		i2c_queue_hook(1);
+	//Set start bit and clear TWINT bit (notifies module to continue)
+	TWCR = (1 << TWSTA) | (1 << TWINT) | (1 << TWEN);
+}
+
+void i2c_stop() {
+	wait_i2c_ready();
+	//Set stop bit and TWINT bit
+	TWCR = (1 << TWSTO) | (1 << TWEN) | (1 << TWINT);
+	if (i2c_queue_hook)
+		i2c_queue_hook(0);
+}
+
+void i2c_write(uint8_t data) {
+	uint8_t status = wait_i2c_ready();
+	//The first byte after a start is the address, switch to that device's speed
+	if (status == TW_START || status == TW_REP_START)
+		i2c_set_speed(data & ~TW_READ);
+	TWDR = data;
+	//Clear interrupt
+	TWCR = (1 << TWINT) | (1 << TWEN);
+}
+
+uint8_t i2c_read() {
+	wait_i2c_ready();
+	return (TWDR);
+}
+
+void i2c_ack() {
+	TWCR = (1 << TWEA) | (1 << TWINT) | (1 << TWEN);
+}
+
+void i2c_nack() {
+	TWCR = (1 << TWINT) | (1 << TWEN);
+}
@@ -0,0 +1,84 @@
+#ifndef I2C_H
+#define I2C_H
+
+#include <stdint.h>
+#include <util/twi.h>
+
+//Bus speed for devices without a profile
+#ifndef TWI_BAUDRATE
+# define TWI_BAUDRATE 100000ul
+#endif
+
+//Fast mode, supported by every device on the board (PCA9555, AHT20, PCF8563)
+#ifndef I2C_FAST_BAUDRATE
+# define I2C_FAST_BAUDRATE 400000ul
+#endif
+
+//SCL = F_CPU / (16 + 2 * TWBR * 4^TWPS), the smallest prescaler that fits
+//TWBR in 8 bits is picked at compile time
+#define I2C_TWBR_DIV(rate) ((F_CPU / (rate) - 16) / 2)
+#define I2C_TWPS(rate) (I2C_TWBR_DIV(rate) <= 255 ? 0 \
+	: I2C_TWBR_DIV(rate) <= 255 * 4 ? 1 \
+	: I2C_TWBR_DIV(rate) <= 255 * 16 ? 2 : 3)
+#define I2C_TWBR(rate) ((uint8_t) (I2C_TWBR_DIV(rate) >> (2 * I2C_TWPS(rate))))
+#define I2C_PROFILE(addr, rate) {(addr), I2C_TWBR(rate), I2C_TWPS(rate)}
+//Number of profiles in a table, for i2c_init
+#define I2C_PROFILE_COUNT(profiles) (sizeof (profiles) / sizeof *(profiles))
+
+//Bus speed for one device, the clock is switched when a transaction
+//addresses a device with a different profile
+typedef struct i2c_profile_s {
+	//Device address with the R/W bit clear
+	uint8_t addr;
+	uint8_t twbr;
+	uint8_t twps;
+} i2c_profile;
+
+//Transaction queue (i2c_async.c), driven by TWI_vect
+#ifndef I2C_QUEUE_SIZE
+# define I2C_QUEUE_SIZE 8
+#endif
+
+enum i2c_xfer_status_e {
+	i2c_xfer_idle,
+	i2c_xfer_queued,
+	i2c_xfer_done,
+	//Address or data byte not acknowledged
+	i2c_xfer_nack,
+	//Arbitration lost or bus error
+	i2c_xfer_error
+};
+
+//Writes wlen bytes, then reads rlen bytes after a repeated start (the last
+//one is not acknowledged). The descriptor and its buffers belong to the
+//queue until status leaves i2c_xfer_queued
+typedef struct i2c_xfer_s {
+	//Device address with the R/W bit clear
+	uint8_t addr;
+	const uint8_t *wbuf;
+	uint8_t wlen;
+	uint8_t *rbuf;
+	uint8_t rlen;
+	//Called from TWI_vect once the transaction is over (may be 0), keep it short
+	void (*done)(struct i2c_xfer_s *xfer);
+	volatile enum i2c_xfer_status_e status;
+} i2c_xfer;
+
+//Set once the queue is in use so the blocking functions wait for it to be
+//idle before taking the bus, and hand the bus back on stop
+extern void (*i2c_queue_hook)(_Bool acquire);
+
+void i2c_init(const i2c_profile *profiles, uint8_t count);
+void i2c_set_speed(uint8_t addr);
+uint8_t wait_i2c_ready();
+void i2c_start();
+void i2c_stop();
+void i2c_write(uint8_t data);
+uint8_t i2c_read();
+void i2c_ack();
+void i2c_nack();
+uint8_t i2c_queue(i2c_xfer *xfer);
+uint8_t i2c_queue_idle();
+void i2c_queue_flush();
+
+#endif
@@ -0,0 +1,165 @@
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <util/atomic.h>
+#include "i2c.h"
+
+#define I2C_QUEUE_MASK (I2C_QUEUE_SIZE - 1)
+
+#if (I2C_QUEUE_SIZE & I2C_QUEUE_MASK) || I2C_QUEUE_SIZE > 256
+# error "I2C_QUEUE_SIZE must be a power of 2 no larger than 256"
+#endif
+
+//Let the hardware run the next step and interrupt us when it is done
+#define TWCR_NEXT ((1 << TWINT) | (1 << TWEN) | (1 << TWIE))
+
+//Transactions are queued at head by i2c_queue and started from tail
+static i2c_xfer *volatile queue[I2C_QUEUE_SIZE];
+static volatile uint8_t queue_head = 0;
+static volatile uint8_t queue_tail = 0;
+//Transaction on the bus, 0 when the engine is idle
+static i2c_xfer *volatile current = 0;
+//Position in the write or read buffer of the current transaction
+static uint8_t pos;
+static _Bool reading;
+//Set while the blocking functions own the bus
+static volatile _Bool sync_owned = 0;
+
+//Must be called with interrupts off. If a stop is already on the wire the
+//start is queued right behind it
+static void start_next(uint8_t stop) {
+	if (sync_owned || queue_head == queue_tail) {
+		current = 0;
+		if (stop)
+			TWCR = (1 << TWINT) | (1 << TWEN) | (1 << TWSTO);
+		return;
+	}
+	current = queue[queue_tail];
+	queue_tail = (queue_tail + 1) & I2C_QUEUE_MASK;
+	pos = 0;
+	//A transaction with nothing to write starts directly in read mode
+	reading = (current->wlen == 0 && current->rlen != 0);
+	//With both TWSTO and TWSTA set the hardware sends stop then start
+	TWCR = TWCR_NEXT | (1 << TWSTA) | stop;
+}
+
+static void finish(enum i2c_xfer_status_e status) {
+	i2c_xfer *xfer = current;
+	xfer->status = status;
+	if (xfer->done)
+		xfer->done(xfer);
+	start_next(1 << TWSTO);
+}
+
+static void twi_step() {
+	i2c_xfer *xfer = current;
+	switch (TW_STATUS) {
+	case TW_START:
+	case TW_REP_START:
+		i2c_set_speed(xfer->addr);
+		TWDR = xfer->addr | (reading ? TW_READ : TW_WRITE);
+		TWCR = TWCR_NEXT;
+		break;
+	case TW_MT_SLA_ACK:
+	case TW_MT_DATA_ACK:
+		if (pos < xfer->wlen) {
+			TWDR = xfer->wbuf[pos++];
+			TWCR = TWCR_NEXT;
+		} else if (xfer->rlen) {
+			//Restart in read mode
+			reading = 1;
+			pos = 0;
+			TWCR = TWCR_NEXT | (1 << TWSTA);
+		} else {
+			finish(i2c_xfer_done);
+		}
+		break;
+	case TW_MR_DATA_ACK:
+		xfer->rbuf[pos++] = TWDR;
+		//fall through
+	case TW_MR_SLA_ACK:
+		//Acknowledge every byte but the last one
+		if (pos + 1 < xfer->rlen)
+			TWCR = TWCR_NEXT | (1 << TWEA);
+		else
+			TWCR = TWCR_NEXT;
+		break;
+	case TW_MR_DATA_NACK:
+		xfer->rbuf[pos++] = TWDR;
+		finish(i2c_xfer_done);
+		break;
+	case TW_MT_SLA_NACK:
+	case TW_MT_DATA_NACK:
+	case TW_MR_SLA_NACK:
+		finish(i2c_xfer_nack);
+		break;
+	default:
+		finish(i2c_xfer_error);
+		break;
+	}
+}
+
+ISR(TWI_vect) {
+	twi_step();
+}
+
+//Must be called with interrupts off
+static void kick() {
+	if (current || sync_owned)
+		return;
+	//A stop sent by the previous transaction may still be on the wire
+	while (TWCR & (1 << TWSTO)) {}
+	start_next(0);
+}
+
+static void sync_hook(_Bool acquire) {
+	if (!acquire) {
+		while (TWCR & (1 << TWSTO)) {}
+		ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+			sync_owned = 0;
+			kick();
+		}
+		return;
+	}
+	while (1) {
+		ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+			if (!current) {
+				//The last queued transaction may still be sending its stop
+				while (TWCR & (1 << TWSTO)) {}
+				sync_owned = 1;
+				return;
+			}
+		}
+		//With interrupts off TWI_vect cannot run, step the engine by hand
+		if (!(SREG & (1 << SREG_I)) && (TWCR & (1 << TWINT)))
+			twi_step();
+	}
+}
+
+//Returns 0 if the queue is full or xfer is still queued from a previous call
+uint8_t i2c_queue(i2c_xfer *xfer) {
+	uint8_t queued = 0;
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		uint8_t next = (queue_head + 1) & I2C_QUEUE_MASK;
+		if (xfer->status != i2c_xfer_queued && next != queue_tail) {
+			i2c_queue_hook = sync_hook;
+			xfer->status = i2c_xfer_queued;
+			queue[queue_head] = xfer;
+			queue_head = next;
+			queued = 1;
+			kick();
+		}
+	}
+	return (queued);
+}
+
+uint8_t i2c_queue_idle() {
+	return (!current && queue_head == queue_tail);
+}
+
+//Waits for every queued transaction to be over
+void i2c_queue_flush() {
+	while (!i2c_queue_idle()) {
+		if (!(SREG & (1 << SREG_I)) && (TWCR & (1 << TWINT)))
+			twi_step();
+	}
+}
@@ -0,0 +1,28 @@
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/sleep.h>
+#include "idle.h"
+
+//Sleeps in mode (SLEEP_MODE_*) until the next interrupt and returns with
+//interrupts on. Call it with interrupts off, after checking there is no work:
+//the instruction after sei always runs, so an interrupt that arrives after the
+//check still wakes the CPU instead of being missed until the next one
+void idle_sleep(uint8_t mode) {
+	set_sleep_mode(mode);
+	sleep_enable();
+	sei();
+	sleep_cpu();
+	sleep_disable();
+}
+
+//Sleeps until an interrupt sets *flag, returns at once if it is already set
+void idle_wait(volatile _Bool *flag, uint8_t mode) {
+	while (1) {
+		cli();
+		if (*flag) {
+			sei();
+			return;
+		}
+		idle_sleep(mode);
+	}
+}
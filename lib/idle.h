@@ -0,0 +1,10 @@
+#ifndef IDLE_H
+#define IDLE_H
+
+#include <stdint.h>
+#include <avr/sleep.h>
+
+void idle_sleep(uint8_t mode);
+void idle_wait(volatile _Bool *flag, uint8_t mode);
+
+#endif
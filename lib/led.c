@@ -0,0 +1,14 @@
+#include <avr/io.h>
+#include "led.h"
+
+//Display the 4 low bits of n on LEDs D1 to D4 (PB0, PB1, PB2 and PB4)
+void display_n_led(uint8_t n) {
+	//Switch all LEDs off
+	PORTB &= ~((1 << PB0) | (1 << PB1) | (1 << PB2) | (1 << PB4));
+	//Deal with third LED not being PORTB3
+	if (n & 0b1000) {
+		PORTB |= (1 << PB4);
+	}
+	//Display the nice bits
+	PORTB |= n & 0b111;
+}
@@ -0,0 +1,8 @@
+#ifndef LED_H
+#define LED_H
+
+#include <stdint.h>
+
+void display_n_led(uint8_t n);
+
+#endif
@@ -0,0 +1,76 @@
+#include <avr/io.h>
+#include "i2c.h"
+#include "pca9555.h"
+
+//Copies of the output, polarity and config registers (in that order, index is
+//command / 2 - 1), starting from their power-on values. A pair is only trusted
+//once written, the expander is not necessarily reset along with the MCU
+static uint8_t shadow[3][2] = {{255, 255}, {0, 0}, {255, 255}};
+static uint8_t shadow_valid = 0;
+
+//Writes to a command pair only send what changed from the shadow copy: nothing,
+//one port (command + 1 addresses port 1 alone) or both
+void pca9555_write(uint8_t command, uint8_t port0, uint8_t port1) {
+	uint8_t i = (command >> 1) - 1;
+	_Bool write0 = 1;
+	_Bool write1 = 1;
+	if (shadow_valid & (1 << i)) {
+		write0 = (port0 != shadow[i][0]);
+		write1 = (port1 != shadow[i][1]);
+		if (!write0 && !write1)
+			return;
+	}
+	pca9555_shadow_set(command, port0, port1);
+	i2c_start();
+	//Address io expander
+	i2c_write(PCA9555_ADDR | TW_WRITE);
+	if (write0) {
+		i2c_write(command);
+		i2c_write(port0);
+		//The expander moves on to port 1 by itself
+		if (write1)
+			i2c_write(port1);
+	} else {
+		i2c_write(command + 1);
+		i2c_write(port1);
+	}
+	i2c_stop();
+}
+
+void pca9555_set_bits(uint8_t command, uint16_t mask) {
+	uint8_t i = (command >> 1) - 1;
+	pca9555_write(command, shadow[i][0] | mask, shadow[i][1] | (mask >> 8));
+}
+
+void pca9555_clear_bits(uint8_t command, uint16_t mask) {
+	uint8_t i = (command >> 1) - 1;
+	pca9555_write(command, shadow[i][0] & ~mask, shadow[i][1] & ~(mask >> 8));
+}
+
+//Records a write done without pca9555_write (e.g. through the transaction queue)
+void pca9555_shadow_set(uint8_t command, uint8_t port0, uint8_t port1) {
+	uint8_t i = (command >> 1) - 1;
+	shadow[i][0] = port0;
+	shadow[i][1] = port1;
+	shadow_valid |= (1 << i);
+}
+
+uint8_t pca9555_read_input0() {
+	i2c_start();
+	//Address io expander
+	i2c_write(PCA9555_ADDR | TW_WRITE);
+	//Send input0 command
+	i2c_write(PCA9555_INPUT);
+	wait_i2c_ready();
+	//Restart in read mode
+	i2c_start();
+	i2c_write(PCA9555_ADDR | TW_READ);
+	wait_i2c_ready();
+	i2c_ack();
+	uint8_t input0 = i2c_read();
+	//Input 1 follows, we don't need it
+	i2c_nack();
+	i2c_read();
+	i2c_stop();
+	return (input0);
+}
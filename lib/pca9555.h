@@ -0,0 +1,42 @@
+#ifndef PCA9555_H
+#define PCA9555_H
+
+#include <stdint.h>
+
+#define PCA9555_ADDR 0b01000000
+
+//Command bytes, each addresses a pair of registers (port 0 then port 1)
+#define PCA9555_INPUT 0x00
+#define PCA9555_OUTPUT 0x02
+#define PCA9555_POLARITY 0x04
+#define PCA9555_CONFIG 0x06
+
+//INT output of the expander (open drain, low while an input differs from its
+//last read). It is not wired to the MCU on the piscine board (PC3 is the RTC
+//interrupt), so inputs are polled. To read them on INT instead, wire it to a
+//free pin and build the library with PCA9555_INT_vect and the matching
+//PCA9555_INT_DDR, _PORT, _PIN, _BIT, _PCMSK, _PCINT and _PCIE
+#if defined(PCA9555_INT_vect) && !(defined(PCA9555_INT_DDR) \
+	&& defined(PCA9555_INT_PORT) && defined(PCA9555_INT_PIN) \
+	&& defined(PCA9555_INT_BIT) && defined(PCA9555_INT_PCMSK) \
+	&& defined(PCA9555_INT_PCINT) && defined(PCA9555_INT_PCIE))
+# error "PCA9555_INT_vect needs every PCA9555_INT_* pin macro"
+#endif
+
+//Bit masks for set_bits/clear_bits, port 0 in the low byte, port 1 in the high byte
+#define PCA9555_IO0(n) (1 << (n))
+#define PCA9555_IO1(n) (1 << ((n) + 8))
+
+void pca9555_write(uint8_t command, uint8_t port0, uint8_t port1);
+void pca9555_set_bits(uint8_t command, uint16_t mask);
+void pca9555_clear_bits(uint8_t command, uint16_t mask);
+void pca9555_shadow_set(uint8_t command, uint8_t port0, uint8_t port1);
+void pca9555_input_init(void (*on_change)(uint16_t inputs));
+void pca9555_poll();
+#ifdef PCA9555_INT_vect
+void pca9555_int_init(void (*on_change)(uint16_t inputs));
+#endif
+uint16_t pca9555_inputs();
+uint8_t pca9555_read_input0();
+
+#endif
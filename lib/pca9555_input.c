@@ -0,0 +1,86 @@
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <util/atomic.h>
+#include "i2c.h"
+#include "pca9555.h"
+
+//Both input ports are read through the transaction queue and cached. Reads
+//are requested with pca9555_poll, or when the expander pulls INT low if the
+//library is built with the PCA9555_INT_* macros. Reading both ports releases INT
+
+static uint8_t input_cmd = PCA9555_INPUT;
+static uint8_t input_buf[2];
+static volatile uint16_t inputs = 0xFFFF;
+static volatile _Bool reread = 0;
+static void (*change_callback)(uint16_t inputs) = 0;
+
+static void input_read_done(i2c_xfer *xfer);
+
+static i2c_xfer input_read = {PCA9555_ADDR, &input_cmd, 1, input_buf, 2, input_read_done, i2c_xfer_idle};
+
+static void request_read() {
+	//A request while the previous read is still queued is caught by the reread
+	if (!i2c_queue(&input_read))
+		reread = 1;
+}
+
+//Runs in TWI_vect
+static void input_read_done(i2c_xfer *xfer) {
+	if (xfer->status == i2c_xfer_done) {
+		inputs = input_buf[0] | (input_buf[1] << 8);
+		if (change_callback)
+			change_callback(inputs);
+	}
+#ifdef PCA9555_INT_vect
+	//Inputs changed again during the read
+	if (!(PCA9555_INT_PIN & (1 << PCA9555_INT_BIT)))
+		reread = 1;
+#endif
+	if (reread) {
+		reread = 0;
+		i2c_queue(xfer);
+	}
+}
+
+//on_change (may be 0) is called from TWI_vect with the new input values,
+//port 0 in the low byte. It must not use the blocking i2c functions
+void pca9555_input_init(void (*on_change)(uint16_t inputs)) {
+	change_callback = on_change;
+	//Initial read
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		request_read();
+	}
+}
+
+//Queues a read of both input ports unless one is already queued, safe to
+//call from an interrupt
+void pca9555_poll() {
+	i2c_queue(&input_read);
+}
+
+#ifdef PCA9555_INT_vect
+ISR(PCA9555_INT_vect) {
+	if (!(PCA9555_INT_PIN & (1 << PCA9555_INT_BIT)))
+		request_read();
+}
+
+void pca9555_int_init(void (*on_change)(uint16_t inputs)) {
+	//INT is open drain, use the internal pull-up
+	PCA9555_INT_DDR &= ~(1 << PCA9555_INT_BIT);
+	PCA9555_INT_PORT |= (1 << PCA9555_INT_BIT);
+	SREG |= (1 << SREG_I);
+	PCA9555_INT_PCMSK |= (1 << PCA9555_INT_PCINT);
+	PCICR |= (1 << PCA9555_INT_PCIE);
+	//The initial read also clears a pending INT
+	pca9555_input_init(on_change);
+}
+#endif
+
+//Last values read from both input ports, port 0 in the low byte
+uint16_t pca9555_inputs() {
+	uint16_t n;
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		n = inputs;
+	}
+	return (n);
+}
@@ -0,0 +1,126 @@
+#include <avr/io.h>
+#include <util/atomic.h>
+#include "prof.h"
+#include "uart.h"
+
+//An entry this close (in cycles) to the end of the previous profiled vector
+//means the interrupt was already pending while that vector ran
+#define PROF_CHAINED_CYCLES 128
+
+typedef struct prof_slot_s {
+	const char *name;
+	uint16_t count;
+	uint16_t min;
+	uint16_t max;
+	uint32_t total;
+	//Entries nested inside or chained right after another profiled vector
+	uint16_t overlaps;
+} prof_slot;
+
+volatile uint8_t prof_depth = 0;
+volatile uint8_t prof_exits = 0;
+static prof_slot slots[PROF_SLOTS];
+static uint8_t tick_cycles = 1;
+static uint16_t tcnt_mask = 0xFFFF;
+static uint16_t last_exit = 0;
+static _Bool has_exited = 0;
+
+void prof_start(uint8_t cycles, uint16_t mask) {
+	tick_cycles = cycles;
+	tcnt_mask = mask;
+	prof_reset();
+	uart_rx_init();
+}
+
+void prof_name(uint8_t slot, const char *name) {
+	slots[slot].name = name;
+}
+
+static void add(prof_slot *s, uint16_t cycles, _Bool overlap) {
+	if (overlap)
+		s->overlaps++;
+	if (s->count == 0 || cycles < s->min)
+		s->min = cycles;
+	if (cycles > s->max)
+		s->max = cycles;
+	s->total += cycles;
+	s->count++;
+	//Halve the counters before the count overflows, the average and the
+	//share of overlaps stay right
+	if (s->count == 0xFFFF) {
+		s->count >>= 1;
+		s->total >>= 1;
+		s->overlaps >>= 1;
+	}
+}
+
+//Called with interrupts off at the end of a vector
+void prof_record(uint8_t slot, uint16_t start, uint16_t end, uint8_t nested) {
+	uint16_t gap = ((start - last_exit) & tcnt_mask) * tick_cycles;
+	add(&slots[slot], ((end - start) & tcnt_mask) * tick_cycles,
+		nested || (has_exited && gap < PROF_CHAINED_CYCLES));
+	prof_depth--;
+	prof_exits++;
+	last_exit = end;
+	has_exited = 1;
+}
+
+//Called from the main context at the end of a section, exits is prof_exits
+//at its start
+void prof_record_main(uint8_t slot, uint16_t start, uint16_t end, uint8_t exits) {
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		add(&slots[slot], ((end - start) & tcnt_mask) * tick_cycles, exits != prof_exits);
+	}
+}
+
+void prof_reset() {
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		for (uint8_t i = 0; i < PROF_SLOTS; i++) {
+			slots[i].count = 0;
+			slots[i].min = 0;
+			slots[i].max = 0;
+			slots[i].total = 0;
+			slots[i].overlaps = 0;
+		}
+		has_exited = 0;
+	}
+}
+
+void prof_report() {
+	for (uint8_t i = 0; i < PROF_SLOTS; i++) {
+		prof_slot s;
+		ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+			s = slots[i];
+		}
+		if (s.name == 0)
+			continue;
+		uart_printstr(s.name);
+		uart_printstr(": n=");
+		uart_print_dec(s.count);
+		if (s.count) {
+			uart_printstr(" min=");
+			uart_print_dec(s.min);
+			uart_printstr(" avg=");
+			uart_print_dec(s.total / s.count);
+			uart_printstr(" max=");
+			uart_print_dec(s.max);
+		}
+		uart_printstr(" overlaps=");
+		uart_print_dec(s.overlaps);
+		uart_print_nl("");
+	}
+}
+
+void prof_poll() {
+	if (!uart_rx_available())
+		return;
+	switch (uart_rx()) {
+	case 'p':
+		prof_report();
+		break;
+	case 'r':
+		prof_reset();
+		uart_print_nl("profiler reset");
+		break;
+	}
+}
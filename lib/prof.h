@@ -0,0 +1,76 @@
+#ifndef PROF_H
+#define PROF_H
+
+#include <stdint.h>
+#include <avr/io.h>
+
+//Opt-in ISR profiler, build with CFLAGS=-DPROF to enable it
+//Wrap the body of a vector with PROF_ENTER(slot) / PROF_EXIT(slot), call
+//prof_init() once and prof_poll() from the main loop, then send 'p' over UART
+//for a report or 'r' to reset the counters
+//A section of the main loop is wrapped with PROF_MAIN_ENTER / PROF_MAIN_EXIT
+//instead: its time includes the vectors that ran during it, and its overlaps
+//count the runs that were interrupted. The counters of a slot are halved when
+//its count would overflow
+
+//Number of vectors that can be profiled
+#ifndef PROF_SLOTS
+# define PROF_SLOTS 6
+#endif
+
+//Time source: timer 1 free running at clk/1 (one tick is one cycle, wraps
+//after 65536 cycles). Exercises that need timer 1 for themselves build with
+//PROF_TIMER0 to sample timer 0 instead, which is then run in normal mode with
+//a 64x prescaler (one tick is 64 cycles, wraps after 16384 cycles)
+//A vector or section running longer than one wrap is reported modulo the wrap
+#ifdef PROF_TIMER0
+# define PROF_TCNT TCNT0
+# define PROF_TCNT_MASK 0xFF
+# define PROF_TICK_CYCLES 64
+#else
+# define PROF_TCNT TCNT1
+# define PROF_TCNT_MASK 0xFFFF
+# define PROF_TICK_CYCLES 1
+#endif
+
+extern volatile uint8_t prof_depth;
+//Profiled vectors that have ended, wraps
+extern volatile uint8_t prof_exits;
+
+void prof_start(uint8_t tick_cycles, uint16_t mask);
+void prof_name(uint8_t slot, const char *name);
+void prof_record(uint8_t slot, uint16_t start, uint16_t end, uint8_t nested);
+void prof_record_main(uint8_t slot, uint16_t start, uint16_t end, uint8_t exits);
+void prof_reset();
+void prof_report();
+void prof_poll();
+
+#ifdef PROF
+//Timestamps are taken after the compiler generated prologue, so the register
+//pushes and pops of the vector are not counted
+# define PROF_ENTER(slot) \
+	uint16_t prof_start_ = PROF_TCNT; \
+	uint8_t prof_nested_ = prof_depth++
+# define PROF_EXIT(slot) prof_record(slot, prof_start_, PROF_TCNT, prof_nested_)
+# define PROF_MAIN_ENTER(slot) \
+	uint8_t prof_exits_ = prof_exits; \
+	uint16_t prof_start_ = PROF_TCNT
+# define PROF_MAIN_EXIT(slot) prof_record_main(slot, prof_start_, PROF_TCNT, prof_exits_)
+#else
+# define PROF_ENTER(slot)
+# define PROF_EXIT(slot)
+# define PROF_MAIN_ENTER(slot)
+# define PROF_MAIN_EXIT(slot)
+#endif
+
+static inline void prof_init() {
+#ifdef PROF_TIMER0
+	TCCR0B |= (1 << CS01) | (1 << CS00);
+#else
+	TCCR1A = 0;
+	TCCR1B = (1 << CS10);
+#endif
+	prof_start(PROF_TICK_CYCLES, PROF_TCNT_MASK);
+}
+
+#endif
@@ -0,0 +1,32 @@
+#include <avr/io.h>
+#include "colour.h"
+#include "rgb.h"
+
+//RGB LED D5 is driven in PWM by timers 0 (red, green) and 2 (blue)
+void rgb_init() {
+	//Set RGB LED to output
+	DDRD |= (1 << DDD3) | (1 << DDD5) | (1 << DDD6);
+	//Set timer 0 and 2 to 0
+	TCNT0 = 0;
+	TCNT2 = 0;
+	//Set timers to PWM phase correct mode
+	TCCR0A |= (1 << WGM00);
+	TCCR2A |= (1 << WGM20);
+	//Set Output Compare to 0 to initialise LED off
+	OCR0A = 0;
+	OCR0B = 0;
+	OCR2B = 0;
+	//Set timers to non inverted mode switches LEDs off when counting up and on when down
+	TCCR0A |= (1 << COM0A1) | (1 << COM0B1);
+	TCCR2A |= (1 << COM2B1);
+	//Set timer clocks with no prescaler
+	TCCR0B |= ((1 << CS00));
+	TCCR2B |= ((1 << CS20));
+}
+
+//Levels are gamma corrected so they look evenly spaced
+void set_rgb(uint8_t r, uint8_t g, uint8_t b) {
+	OCR0B = colour_gamma(r);
+	OCR0A = colour_gamma(g);
+	OCR2B = colour_gamma(b);
+}
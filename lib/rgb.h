@@ -0,0 +1,9 @@
+#ifndef RGB_H
+#define RGB_H
+
+#include <stdint.h>
+
+void rgb_init();
+void set_rgb(uint8_t r, uint8_t g, uint8_t b);
+
+#endif
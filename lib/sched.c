@@ -0,0 +1,181 @@
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <util/atomic.h>
+#include "idle.h"
+#include "sched.h"
+#include "uart.h"
+
+static sched_task *tasks = 0;
+static volatile uint16_t ticks = 0;
+//Counter of the timer that calls sched_tick, gives run times below a tick
+static volatile uint8_t *fine_counter = 0;
+static uint16_t fine_counts = 1;
+static uint8_t fine_cycles = 1;
+
+typedef struct sched_time_s {
+	uint16_t ticks;
+	uint8_t count;
+} sched_time;
+
+//Time accounting for the idle report, in timer counts
+static sched_time last_run;
+static uint32_t total_counts = 0;
+static uint32_t idle_counts = 0;
+
+//tick_counter is the count register of the timer driving sched_tick, which
+//counts counts_per_tick times per tick, cycles_per_count cycles each (e.g.
+//&TCNT0, 256, 64 for timer 0 overflowing with a 64x prescaler)
+void sched_init(volatile uint8_t *tick_counter, uint16_t counts_per_tick, uint8_t cycles_per_count) {
+	fine_counter = tick_counter;
+	fine_counts = counts_per_tick;
+	fine_cycles = cycles_per_count;
+	sched_reset_stats();
+}
+
+//Tasks must be added from the main context before they are started or posted
+void sched_add(sched_task *task) {
+	task->next = tasks;
+	tasks = task;
+}
+
+//Runs task delay ticks from now, then every period ticks if period is not 0
+void sched_start(sched_task *task, uint16_t delay, uint16_t period) {
+	task->deadline = sched_ticks() + delay;
+	task->period = period;
+	task->timed = 1;
+}
+
+void sched_stop(sched_task *task) {
+	task->timed = 0;
+	task->posted = 0;
+}
+
+//Safe from interrupts: the task runs once on the next sched_run, several posts
+//before it runs count as one
+void sched_post(sched_task *task) {
+	task->posted = 1;
+}
+
+//Call once per tick from a timer interrupt
+void sched_tick() {
+	ticks++;
+}
+
+uint16_t sched_ticks() {
+	uint16_t n;
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		n = ticks;
+	}
+	return (n);
+}
+
+//Read without masking interrupts so the tick can't be missed while the counter
+//wraps
+static sched_time now() {
+	sched_time time;
+	do {
+		time.ticks = ticks;
+		time.count = fine_counter ? *fine_counter : 0;
+	} while (time.ticks != ticks);
+	return (time);
+}
+
+//Timer counts between two times less than 65536 ticks apart
+static uint32_t elapsed(sched_time start, sched_time end) {
+	return ((uint32_t) (uint16_t) (end.ticks - start.ticks) * fine_counts + end.count - start.count);
+}
+
+static void run_task(sched_task *task) {
+	sched_time start = now();
+	task->run();
+	uint32_t cycles = elapsed(start, now()) * fine_cycles;
+	task->runs++;
+	task->total_cycles += cycles;
+	if (cycles > task->max_cycles)
+		task->max_cycles = cycles;
+}
+
+//Runs every task that is due or posted once, returns how many ran (0 means
+//there is nothing to do until the next interrupt)
+uint8_t sched_run() {
+	uint8_t ran = 0;
+	sched_time time = now();
+	total_counts += elapsed(last_run, time);
+	last_run = time;
+	for (sched_task *task = tasks; task; task = task->next) {
+		_Bool due = 0;
+		if (task->posted) {
+			task->posted = 0;
+			due = 1;
+		}
+		if (task->timed && (int16_t) (sched_ticks() - task->deadline) >= 0) {
+			if (task->period)
+				task->deadline += task->period;
+			else
+				task->timed = 0;
+			due = 1;
+		}
+		if (due) {
+			run_task(task);
+			ran++;
+		}
+	}
+	return (ran);
+}
+
+static _Bool pending() {
+	uint16_t t = ticks;
+	for (sched_task *task = tasks; task; task = task->next) {
+		if (task->posted || (task->timed && (int16_t) (t - task->deadline) >= 0))
+			return (1);
+	}
+	return (0);
+}
+
+//Sleeps in idle mode until the next interrupt unless a task is due or was
+//posted since the last sched_run. The time asleep (including the interrupt
+//that ends it) counts as idle in the report
+void sched_idle() {
+	sched_time start = now();
+	cli();
+	if (pending()) {
+		sei();
+		return;
+	}
+	idle_sleep(SLEEP_MODE_IDLE);
+	idle_counts += elapsed(start, now());
+}
+
+void sched_reset_stats() {
+	last_run = now();
+	total_counts = 0;
+	idle_counts = 0;
+	for (sched_task *task = tasks; task; task = task->next) {
+		task->runs = 0;
+		task->max_cycles = 0;
+		task->total_cycles = 0;
+	}
+}
+
+#define CYCLES_PER_US (F_CPU / 1000000)
+
+//Run count, average and longest run time in microseconds of every task, then
+//the share of time spent asleep in sched_idle
+void sched_report() {
+	for (sched_task *task = tasks; task; task = task->next) {
+		uart_printstr(task->name);
+		uart_printstr(": n=");
+		uart_print_dec(task->runs);
+		if (task->runs) {
+			uart_printstr(" avg=");
+			uart_print_dec(task->total_cycles / task->runs / CYCLES_PER_US);
+			uart_printstr("us max=");
+			uart_print_dec(task->max_cycles / CYCLES_PER_US);
+			uart_printstr("us");
+		}
+		uart_print_nl("");
+	}
+	uart_printstr("idle: ");
+	uart_print_dec(total_counts < 100 ? 0 : idle_counts / (total_counts / 100));
+	uart_print_nl("%");
+}
@@ -0,0 +1,39 @@
+#ifndef SCHED_H
+#define SCHED_H
+
+#include <stdint.h>
+
+//Cooperative scheduler: an interrupt calls sched_tick, tasks run to completion
+//from sched_run in the main loop. Interrupts only post tasks or keep time
+
+#define SCHED_TASK(name, run) {name, run, 0, 0, 0, 0, 0, 0, 0, 0}
+
+typedef struct sched_task_s {
+	const char *name;
+	void (*run)();
+	//Ticks between runs, 0 for a one-shot task
+	uint16_t period;
+	//Tick of the next timed run
+	uint16_t deadline;
+	_Bool timed;
+	//Set by sched_post (from any context), cleared when the task runs
+	volatile _Bool posted;
+	uint16_t runs;
+	uint32_t max_cycles;
+	uint32_t total_cycles;
+	struct sched_task_s *next;
+} sched_task;
+
+void sched_init(volatile uint8_t *tick_counter, uint16_t counts_per_tick, uint8_t cycles_per_count);
+void sched_add(sched_task *task);
+void sched_start(sched_task *task, uint16_t delay, uint16_t period);
+void sched_stop(sched_task *task);
+void sched_post(sched_task *task);
+void sched_tick();
+uint16_t sched_ticks();
+uint8_t sched_run();
+void sched_idle();
+void sched_reset_stats();
+void sched_report();
+
+#endif
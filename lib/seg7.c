@@ -0,0 +1,78 @@
+#include <avr/io.h>
+#include <util/atomic.h>
+#include "fmt.h"
+#include "i2c.h"
+#include "pca9555.h"
+#include "seg7.h"
+
+volatile uint8_t seg7_frame[4] = {0, 0, 0, 0};
+
+static const uint8_t digit_segments[10] = {
+	0b00111111,
+	0b00000110,
+	0b01011011,
+	0b01001111,
+	0b01100110,
+	0b01101101,
+	0b01111101,
+	0b00000111,
+	0b01111111,
+	0b01101111
+};
+
+uint8_t seg7_digit(uint8_t n) {
+	//Callers pass a single digit, only pay for the modulo otherwise
+	if (n > 9)
+		n %= 10;
+	return (digit_segments[n]);
+}
+
+uint8_t seg7_char(char c) {
+	if (c >= '0' && c <= '9')
+		return (seg7_digit(c - '0'));
+	switch (c) {
+	case '-':
+		return (0b01000000);
+	case 'C':
+		return (0b00111001);
+	case 'F':
+		return (0b01110001);
+	case 'H':
+		return (0b01110110);
+	}
+	return (0);
+}
+
+//Renders the last four decimal digits of n, leading zeros are left blank
+//unless asked for (the units digit is always shown)
+void seg7_render_dec(uint16_t n, _Bool leading_zeros) {
+	char digits[FMT_DEC_SIZE];
+	uint8_t len = fmt_dec(digits, n, 4, leading_zeros ? '0' : ' ');
+	uint8_t frame[4];
+	for (uint8_t i = 0; i < 4; i++) {
+		frame[i] = seg7_char(digits[len - 4 + i]);
+	}
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		for (uint8_t i = 0; i < 4; i++) {
+			seg7_frame[i] = frame[i];
+		}
+	}
+}
+
+//io0 selects the digit (its common cathode pulled low) and the IO0 LEDs
+//The output registers are written in a single transaction: the expander
+//alternates between port 0 and port 1 after each data byte, so all digits are
+//turned off, the segments changed, then the new digit turned on. No digit is
+//ever lit with the previous segments, which is what the separate wipe
+//transaction used to prevent
+void seg7_show(uint8_t io0, uint8_t segments) {
+	i2c_start();
+	//Address io expander
+	i2c_write(PCA9555_ADDR | TW_WRITE);
+	i2c_write(PCA9555_OUTPUT);
+	i2c_write(io0 | SEG7_DIGITS);
+	i2c_write(segments);
+	i2c_write(io0);
+	i2c_stop();
+	pca9555_shadow_set(PCA9555_OUTPUT, io0, segments);
+}
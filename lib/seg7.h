@@ -0,0 +1,23 @@
+#ifndef SEG7_H
+#define SEG7_H
+
+#include <stdint.h>
+
+//Decimal point segment
+#define SEG7_DOT (1 << 7)
+
+//Common cathodes of the four digits on IO0 (active low)
+#define SEG7_DIGITS 0xF0
+
+//Segment patterns of the four digits, left to right, shown one at a time by
+//seg7_refresh_async. Writers render into it only when the value changes
+extern volatile uint8_t seg7_frame[4];
+
+uint8_t seg7_digit(uint8_t n);
+uint8_t seg7_char(char c);
+void seg7_show(uint8_t io0, uint8_t segments);
+uint8_t seg7_show_async(uint8_t io0, uint8_t segments);
+void seg7_render_dec(uint16_t n, _Bool leading_zeros);
+uint8_t seg7_refresh_async(uint8_t io0);
+
+#endif
@@ -0,0 +1,32 @@
+#include <avr/io.h>
+#include "i2c.h"
+#include "pca9555.h"
+#include "seg7.h"
+
+static uint8_t show_buf[4] = {PCA9555_OUTPUT, 255, 0, 255};
+static i2c_xfer show = {PCA9555_ADDR, show_buf, 4, 0, 0, 0, i2c_xfer_idle};
+static uint8_t refresh_position = 0;
+
+//Same as seg7_show but goes through the transaction queue and returns at once
+//Returns 0 (and displays nothing) while the previous digit is still being sent
+uint8_t seg7_show_async(uint8_t io0, uint8_t segments) {
+	if (show.status == i2c_xfer_queued)
+		return (0);
+	show_buf[1] = io0 | SEG7_DIGITS;
+	show_buf[2] = segments;
+	show_buf[3] = io0;
+	if (!i2c_queue(&show))
+		return (0);
+	pca9555_shadow_set(PCA9555_OUTPUT, io0, segments);
+	return (1);
+}
+
+//Shows the next digit of seg7_frame, io0 holds the other IO0 outputs (LEDs)
+//Moves on to the following digit only once this one is queued
+uint8_t seg7_refresh_async(uint8_t io0) {
+	uint8_t position = refresh_position;
+	if (!seg7_show_async(io0 & ~(1 << (4 + position)), seg7_frame[position]))
+		return (0);
+	refresh_position = (position + 1) & 3;
+	return (1);
+}
@@ -0,0 +1,69 @@
+#include <avr/io.h>
+#include "spi.h"
+
+static uint8_t divider = SPI_DIVIDER;
+
+void spi_master_init() {
+	//Set SCK, MOSI and SS to outputs
+	DDRB |= (1 << DDB2) | (1 << DDB3) | (1 << DDB5);
+	//Set SPI to master
+	SPCR |= (1 << MSTR);
+	spi_set_clock(SPI_DIVIDER);
+	//Enable SPI
+	SPCR |= (1 << SPE);
+}
+
+//SCK = F_CPU / divider, divider is a power of 2 from 2 to 128 (8MHz to 125kHz)
+void spi_set_clock(uint8_t div) {
+	//SPR1:0 divide by 4, 16, 64 or 128, SPI2X halves the first three
+	uint8_t spr;
+	_Bool double_speed = 0;
+	switch (div) {
+	case 2:
+		double_speed = 1;
+		//Fall through
+	case 4:
+		spr = 0;
+		break;
+	case 8:
+		double_speed = 1;
+		//Fall through
+	case 16:
+		spr = (1 << SPR0);
+		break;
+	case 32:
+		double_speed = 1;
+		//Fall through
+	case 64:
+		spr = (1 << SPR1);
+		break;
+	default:
+		div = 128;
+		spr = (1 << SPR1) | (1 << SPR0);
+		break;
+	}
+	SPCR = (SPCR & ~((1 << SPR1) | (1 << SPR0))) | spr;
+	if (double_speed)
+		SPSR |= (1 << SPI2X);
+	else
+		SPSR &= ~(1 << SPI2X);
+	divider = div;
+}
+
+uint8_t spi_get_clock() {
+	return (divider);
+}
+
+void spi_enable() {
+	SPCR |= (1 << SPE);
+}
+
+void spi_disable() {
+	SPCR &= ~(1 << SPE);
+}
+
+void spi_transmit(uint8_t data) {
+	SPDR = data;
+	//Wait for transmission to finish
+	while (!(SPSR & (1 << SPIF))) {}
+}
@@ -0,0 +1,25 @@
+#ifndef SPI_H
+#define SPI_H
+
+#include <stdint.h>
+
+//Default SCK divider: 16 is 1MHz, APA102 take several MHz over short wires
+#ifndef SPI_DIVIDER
+# define SPI_DIVIDER 16
+#endif
+
+//Below this divider a byte takes less time than the SPI interrupt, so
+//spi_send_async sends by polling instead when interrupts are on
+#define SPI_POLL_DIVIDER 4
+
+void spi_master_init();
+void spi_set_clock(uint8_t div);
+uint8_t spi_get_clock();
+void spi_enable();
+void spi_disable();
+void spi_transmit(uint8_t data);
+uint8_t spi_send_async(const uint8_t *buf, uint16_t len, void (*done)());
+uint8_t spi_async_busy();
+void spi_async_flush();
+
+#endif
@@ -0,0 +1,85 @@
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <util/atomic.h>
+#include "spi.h"
+
+static const uint8_t *tx_buf;
+static volatile uint16_t tx_left = 0;
+static void (*tx_done)() = 0;
+
+//At 2 or 4 bits per microsecond the interrupt (~50 cycles) can't keep up,
+//polling sends a byte every ~20 or ~36 cycles and takes less CPU in total
+static void send_polled(const uint8_t *buf, uint16_t len, void (*done)()) {
+	for (uint16_t i = 0; i < len; i++)
+		spi_transmit(buf[i]);
+	tx_left = 0;
+	if (done)
+		done();
+}
+
+//Sends len bytes of buf from SPI_STC_vect while the CPU does something else,
+//then calls done (may be 0) from the interrupt, which may start the next
+//frame. buf must not change until then. Returns 0 if a frame is still being
+//sent. Don't use spi_transmit meanwhile. At dividers of SPI_POLL_DIVIDER and
+//below the bytes are sent before it returns, unless interrupts are off (in an
+//ISR or an ATOMIC_BLOCK): polling would keep them off for the whole frame, so
+//the interrupt sends it once they are back on
+uint8_t spi_send_async(const uint8_t *buf, uint16_t len, void (*done)()) {
+	if (len == 0)
+		return (0);
+	if (spi_get_clock() <= SPI_POLL_DIVIDER && (SREG & (1 << SREG_I))) {
+		//tx_left keeps other senders out until it is done
+		ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+			if (tx_left)
+				return (0);
+			tx_left = len;
+		}
+		send_polled(buf, len, done);
+		return (1);
+	}
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		if (tx_left)
+			return (0);
+		tx_buf = buf + 1;
+		tx_left = len;
+		tx_done = done;
+		//Reading SPSR then writing SPDR clears a SPIF left by spi_transmit
+		(void) SPSR;
+		SPDR = buf[0];
+		SPCR |= (1 << SPIE);
+	}
+	return (1);
+}
+
+uint8_t spi_async_busy() {
+	uint8_t busy;
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		busy = tx_left != 0;
+	}
+	return (busy);
+}
+
+static void step() {
+	tx_left--;
+	if (tx_left) {
+		SPDR = *tx_buf++;
+		return;
+	}
+	SPCR &= ~(1 << SPIE);
+	if (tx_done)
+		tx_done();
+}
+
+//One interrupt per byte: ~50 cycles every 8us at 1MHz instead of spinning
+ISR(SPI_STC_vect) {
+	step();
+}
+
+//Waits for the frame being sent (and any frame done starts), sends it by hand
+//if interrupts are off
+void spi_async_flush() {
+	while (spi_async_busy()) {
+		if (!(SREG & (1 << SREG_I)) && (SPSR & (1 << SPIF)))
+			step();
+	}
+}
@@ -0,0 +1,254 @@
+#include <string.h>
+#include <avr/io.h>
+#include "aht20.h"
+#include "fake_i2c.h"
+#include "i2c.h"
+#include "mock.h"
+#include "pca9555.h"
+
+fake_pca9555 fake_expander;
+fake_aht20 fake_sensor;
+fake_pcf8563 fake_rtc;
+uint16_t fake_i2c_nacks;
+uint8_t fake_i2c_twbr;
+uint8_t fake_i2c_twps;
+
+//TWCR bit 1 does not exist on the chip: it is set in the value the mock leaves
+//behind, so a write by the code under test shows up as a change
+#define TWCR_LEFT (1 << 1)
+
+static volatile uint8_t twcr = TWCR_LEFT;
+static uint8_t twcr_left = TWCR_LEFT;
+static volatile uint8_t twsr = TW_NO_INFO;
+static uint8_t status = TW_NO_INFO;
+
+enum fake_device_e {
+	device_none,
+	device_expander,
+	device_sensor,
+	device_rtc
+};
+
+//Transaction in progress
+static _Bool bus_busy = 0;
+static _Bool expect_address = 0;
+static enum fake_device_e device = device_none;
+static _Bool reading = 0;
+static uint8_t count = 0;
+static uint8_t written[8];
+static uint8_t sensor_busy_left = 0;
+
+void fake_i2c_reset(void) {
+	memset(&fake_expander, 0, sizeof fake_expander);
+	//Power-on values
+	fake_expander.regs[0] = 0xFF;
+	fake_expander.regs[1] = 0xFF;
+	fake_expander.regs[2] = 0xFF;
+	fake_expander.regs[3] = 0xFF;
+	fake_expander.regs[6] = 0xFF;
+	fake_expander.regs[7] = 0xFF;
+	memset(&fake_sensor, 0, sizeof fake_sensor);
+	memset(&fake_rtc, 0, sizeof fake_rtc);
+	fake_i2c_nacks = 0;
+	fake_i2c_twbr = 0;
+	fake_i2c_twps = 0;
+	twcr = TWCR_LEFT;
+	twcr_left = TWCR_LEFT;
+	twsr = TW_NO_INFO;
+	status = TW_NO_INFO;
+	bus_busy = 0;
+	expect_address = 0;
+	device = device_none;
+	sensor_busy_left = 0;
+}
+
+static uint8_t crc8(const uint8_t *data, uint8_t len) {
+	uint8_t crc = 0xFF;
+	for (uint8_t i = 0; i < len; i++) {
+		crc ^= data[i];
+		for (uint8_t bit = 0; bit < 8; bit++)
+			crc = (crc & 0x80) ? (crc << 1) ^ 0x31 : crc << 1;
+	}
+	return (crc);
+}
+
+static uint8_t sensor_byte(uint8_t index) {
+	uint32_t h = fake_sensor.raw_humidity;
+	uint32_t t = fake_sensor.raw_temp;
+	uint8_t data[6] = {
+		AHT20_CALIBRATED | 0x10 | (sensor_busy_left ? AHT20_BUSY : 0),
+		h >> 12,
+		h >> 4,
+		((h & 0x0F) << 4) | ((t >> 16) & 0x0F),
+		t >> 8,
+		t
+	};
+	if (index < 6)
+		return (data[index]);
+	return (crc8(data, 6));
+}
+
+//Device models: each returns whether the device acknowledged the byte
+
+static _Bool address(uint8_t data) {
+	reading = data & TW_READ;
+	count = 0;
+	switch (data & ~TW_READ) {
+	case PCA9555_ADDR:
+		device = device_expander;
+		if (reading)
+			fake_expander.reads++;
+		break;
+	case AHT20_ADDR:
+		device = device_sensor;
+		if (reading)
+			fake_sensor.reads++;
+		break;
+	case FAKE_PCF8563_ADDR:
+		device = device_rtc;
+		break;
+	default:
+		device = device_none;
+		fake_i2c_nacks++;
+		return (0);
+	}
+	return (1);
+}
+
+static _Bool write_byte(uint8_t data) {
+	if (count < sizeof written)
+		written[count] = data;
+	count++;
+	switch (device) {
+	case device_expander:
+		if (count == 1) {
+			fake_expander.command = data & 7;
+			break;
+		}
+		//Input registers are read only
+		if (fake_expander.command >= 2) {
+			if (count == 2)
+				fake_expander.writes++;
+			fake_expander.regs[fake_expander.command] = data;
+		}
+		//Moves between the two registers of the pair
+		fake_expander.command ^= 1;
+		break;
+	case device_sensor:
+		if (count == 3 && written[0] == 0xAC && written[1] == 0x33 && written[2] == 0x00) {
+			fake_sensor.triggers++;
+			sensor_busy_left = fake_sensor.busy_reads;
+		}
+		break;
+	case device_rtc:
+		if (count == 1)
+			fake_rtc.pointer = data & 15;
+		else
+			fake_rtc.regs[fake_rtc.pointer++ & 15] = data;
+		break;
+	default:
+		return (0);
+	}
+	return (1);
+}
+
+static uint8_t read_byte(void) {
+	uint8_t data = 0xFF;
+	switch (device) {
+	case device_expander:
+		data = fake_expander.regs[fake_expander.command];
+		fake_expander.command ^= 1;
+		break;
+	case device_sensor:
+		data = sensor_byte(count);
+		//The status byte is read: one busy read less
+		if (count == 0 && sensor_busy_left)
+			sensor_busy_left--;
+		break;
+	case device_rtc:
+		data = fake_rtc.regs[fake_rtc.pointer++ & 15];
+		break;
+	default:
+		break;
+	}
+	count++;
+	return (data);
+}
+
+//Runs the step the TWCR value c asks for, returns 1 if it ends with TWINT set
+static _Bool step(uint8_t c) {
+	if (!(c & (1 << TWEN)))
+		return (0);
+	if (c & (1 << TWSTO)) {
+		bus_busy = 0;
+		device = device_none;
+		//With TWSTA too the start follows the stop
+		if (!(c & (1 << TWSTA)))
+			return (0);
+	}
+	if (c & (1 << TWSTA)) {
+		status = bus_busy ? TW_REP_START : TW_START;
+		bus_busy = 1;
+		expect_address = 1;
+		return (1);
+	}
+	if (!bus_busy) {
+		status = TW_BUS_ERROR;
+		return (1);
+	}
+	if (expect_address) {
+		expect_address = 0;
+		fake_i2c_twbr = TWBR;
+		fake_i2c_twps = twsr & 3;
+		_Bool ack = address(TWDR);
+		if (reading)
+			status = ack ? TW_MR_SLA_ACK : TW_MR_SLA_NACK;
+		else
+			status = ack ? TW_MT_SLA_ACK : TW_MT_SLA_NACK;
+	} else if (reading) {
+		TWDR = read_byte();
+		status = (c & (1 << TWEA)) ? TW_MR_DATA_ACK : TW_MR_DATA_NACK;
+	} else {
+		status = write_byte(TWDR) ? TW_MT_DATA_ACK : TW_MT_DATA_NACK;
+	}
+	return (1);
+}
+
+//Acts on a TWCR write since the last access. Writing TWINT as 1 clears the
+//flag and starts a step, which is over at once
+static void twi_update(void) {
+	if (twcr == twcr_left)
+		return;
+	uint8_t c = twcr & ~TWCR_LEFT;
+	_Bool flag = twcr_left & (1 << TWINT);
+	if (c & (1 << TWINT))
+		flag = step(c);
+	//The hardware clears TWSTO once the stop is sent
+	twcr = (c & ~((1 << TWINT) | (1 << TWSTO))) | (flag ? (1 << TWINT) : 0) | TWCR_LEFT;
+	twcr_left = twcr;
+	twsr = (twsr & 3) | status;
+}
+
+_Bool fake_i2c_pending(void) {
+	twi_update();
+	return ((twcr & (1 << TWINT)) && (twcr & (1 << TWIE)));
+}
+
+volatile uint8_t *mock_twcr(void) {
+	twi_update();
+	mock_interrupts();
+	return (&twcr);
+}
+
+volatile uint8_t *mock_twsr(void) {
+	twi_update();
+	mock_interrupts();
+	//The status bits are read only
+	twsr = (twsr & 3) | status;
+	return (&twsr);
+}
+
+void fake_i2c_run(void) {
+	while (fake_i2c_pending())
+		mock_vector(TWI_vect);
+}
@@ -0,0 +1,55 @@
+#ifndef FAKE_I2C_H
+#define FAKE_I2C_H
+
+#include <stdint.h>
+
+//TWI hardware behind TWCR, TWSR and TWDR for the real i2c.c and i2c_async.c,
+//with models of the devices on the board on the bus. A step started by a TWCR
+//write is over at the next TWCR or TWSR access, TWI_vect then runs on its own
+//while interrupts are on (see mock_interrupts), with them off fake_i2c_run
+//plays the interrupt
+
+#define FAKE_PCF8563_ADDR 0b10100010
+
+//PCA9555: registers in command order (input, output, polarity, config), the
+//tests set the input pair. Writes only count transactions that wrote a register
+typedef struct fake_pca9555_s {
+	uint8_t regs[8];
+	uint8_t command;
+	uint16_t writes;
+	uint16_t reads;
+} fake_pca9555;
+
+//AHT20: 20 bit raw values returned by the next measurement, the status reads
+//busy for busy_reads reads after a trigger
+typedef struct fake_aht20_s {
+	uint32_t raw_humidity;
+	uint32_t raw_temp;
+	uint8_t busy_reads;
+	uint16_t triggers;
+	uint16_t reads;
+} fake_aht20;
+
+//PCF8563: 16 registers, the address pointer moves on after each byte
+typedef struct fake_pcf8563_s {
+	uint8_t regs[16];
+	uint8_t pointer;
+} fake_pcf8563;
+
+extern fake_pca9555 fake_expander;
+extern fake_aht20 fake_sensor;
+extern fake_pcf8563 fake_rtc;
+//Address bytes that no device acknowledged
+extern uint16_t fake_i2c_nacks;
+//TWBR and the prescaler when the last address byte was sent
+extern uint8_t fake_i2c_twbr;
+extern uint8_t fake_i2c_twps;
+
+void fake_i2c_reset(void);
+//Runs TWI_vect while it is due: until the queue is idle, including the
+//transactions queued by done callbacks
+void fake_i2c_run(void);
+//Ends a pending step, returns 1 if TWI_vect is due (TWINT and TWIE set)
+_Bool fake_i2c_pending(void);
+
+#endif
@@ -0,0 +1,352 @@
+#include <setjmp.h>
+#include <signal.h>
+#include <string.h>
+#include <sys/time.h>
+#include <avr/interrupt.h>
+#include <avr/io.h>
+#include <avr/sleep.h>
+#include "fake_i2c.h"
+#include "mock.h"
+
+volatile uint8_t PORTB;
+volatile uint8_t DDRB;
+volatile uint8_t PINB;
+volatile uint8_t PORTC;
+volatile uint8_t DDRC;
+volatile uint8_t PINC;
+volatile uint8_t PORTD;
+volatile uint8_t DDRD;
+volatile uint8_t PIND;
+volatile uint8_t UCSR0B;
+volatile uint8_t UCSR0C;
+volatile uint8_t TWDR;
+volatile uint8_t TWBR;
+volatile uint8_t TWAR;
+volatile uint8_t TWAMR;
+volatile uint8_t SPCR;
+volatile uint8_t ADMUX;
+volatile uint8_t ADCSRB;
+volatile uint8_t DIDR0;
+volatile uint8_t TCCR0A;
+volatile uint8_t TCCR0B;
+volatile uint8_t TCNT0;
+volatile uint8_t OCR0A;
+volatile uint8_t OCR0B;
+volatile uint8_t TIMSK0;
+volatile uint8_t TIFR0;
+volatile uint8_t TCCR1A;
+volatile uint8_t TCCR1B;
+volatile uint8_t TCCR1C;
+volatile uint8_t TIMSK1;
+volatile uint8_t TIFR1;
+volatile uint8_t TCCR2A;
+volatile uint8_t TCCR2B;
+volatile uint8_t TCNT2;
+volatile uint8_t OCR2A;
+volatile uint8_t OCR2B;
+volatile uint8_t TIMSK2;
+volatile uint8_t TIFR2;
+volatile uint8_t ASSR;
+volatile uint8_t EICRA;
+volatile uint8_t EIMSK;
+volatile uint8_t EIFR;
+volatile uint8_t PCICR;
+volatile uint8_t PCIFR;
+volatile uint8_t PCMSK0;
+volatile uint8_t PCMSK1;
+volatile uint8_t PCMSK2;
+volatile uint8_t SREG;
+volatile uint8_t SMCR;
+volatile uint8_t MCUCR;
+volatile uint8_t MCUSR;
+volatile uint8_t PRR;
+volatile uint8_t SPMCSR;
+volatile uint8_t GTCCR;
+volatile uint8_t ACSR;
+volatile uint8_t WDTCSR;
+volatile uint8_t CLKPR;
+volatile uint16_t ADC;
+volatile uint16_t OCR1A;
+volatile uint16_t OCR1B;
+volatile uint16_t TCNT1;
+volatile uint16_t ICR1;
+volatile uint16_t UBRR0;
+volatile uint16_t UDR0 = MOCK_EMPTY;
+volatile uint16_t SPDR = MOCK_EMPTY;
+static volatile uint8_t ucsr0a;
+static volatile uint8_t spsr;
+static volatile uint8_t adcsra;
+//Set while USART_RX_vect reads a received character from UDR0
+static _Bool receiving;
+
+_Bool mock_uart_busy;
+_Bool mock_uart_auto;
+const char *mock_uart_input;
+char mock_uart_out[1024];
+uint16_t mock_uart_len;
+uint8_t mock_spi_out[4096];
+uint16_t mock_spi_len;
+uint16_t mock_spi_masked;
+uint16_t mock_adc_input[16];
+uint16_t mock_adc_conversions;
+uint16_t mock_sleeps[8];
+void (*mock_sleep_hook)(void);
+uint32_t mock_time_us;
+uint8_t mock_eeprom[1024];
+void (*mock_delay_hook)(void);
+
+//Vectors of the sources a test does not link
+__attribute__((weak)) void USART_UDRE_vect(void) {}
+__attribute__((weak)) void USART_RX_vect(void) {}
+__attribute__((weak)) void SPI_STC_vect(void) {}
+__attribute__((weak)) void ADC_vect(void) {}
+__attribute__((weak)) void TWI_vect(void) {}
+
+//As the chip does: interrupts are off in the vector, reti restores them
+static void run_vector(void (*vector)(void)) {
+	uint8_t sreg = SREG;
+	SREG &= ~(1 << SREG_I);
+	vector();
+	SREG = sreg;
+}
+
+static void uart_shift(void) {
+	if (receiving)
+		return;
+	if (mock_uart_busy) {
+		//A character is on the wire
+		ucsr0a &= ~((1 << UDRE0) | (1 << TXC0));
+		return;
+	}
+	if (UDR0 != MOCK_EMPTY && mock_uart_len < sizeof mock_uart_out - 1) {
+		mock_uart_out[mock_uart_len++] = (char) UDR0;
+		UDR0 = MOCK_EMPTY;
+		ucsr0a |= (1 << TXC0);
+	}
+	ucsr0a |= (1 << UDRE0);
+}
+
+volatile uint8_t *mock_ucsr0a(void) {
+	uart_shift();
+	return (&ucsr0a);
+}
+
+void mock_uart_drain(void) {
+	uart_shift();
+	while (!mock_uart_busy && (UCSR0B & (1 << UDRIE0))) {
+		run_vector(USART_UDRE_vect);
+		uart_shift();
+	}
+}
+
+const char *mock_uart_take(void) {
+	static char taken[sizeof mock_uart_out];
+	uart_shift();
+	mock_uart_out[mock_uart_len] = '\0';
+	strcpy(taken, mock_uart_out);
+	mock_uart_len = 0;
+	return (taken);
+}
+
+void mock_uart_receive(char c) {
+	//UDR0 is two registers on the chip, keep a character waiting to be sent
+	uart_shift();
+	uint16_t pending = UDR0;
+	UDR0 = (uint8_t) c;
+	receiving = 1;
+	run_vector(USART_RX_vect);
+	receiving = 0;
+	UDR0 = pending;
+}
+
+static void spi_shift(void) {
+	//Bytes past the end of mock_spi_out are dropped
+	if (SPDR != MOCK_EMPTY && mock_spi_len < sizeof mock_spi_out) {
+		mock_spi_out[mock_spi_len++] = (uint8_t) SPDR;
+		if (!(SREG & (1 << SREG_I)))
+			mock_spi_masked++;
+	}
+	SPDR = MOCK_EMPTY;
+	spsr |= (1 << SPIF);
+}
+
+volatile uint8_t *mock_spsr(void) {
+	spi_shift();
+	return (&spsr);
+}
+
+void mock_spi_drain(void) {
+	spi_shift();
+	while (SPCR & (1 << SPIE)) {
+		run_vector(SPI_STC_vect);
+		spi_shift();
+	}
+}
+
+void mock_adc_convert(void) {
+	uint16_t value = mock_adc_input[ADMUX & 0x0F] & 0x3FF;
+	ADC = (ADMUX & (1 << ADLAR)) ? value << 6 : value;
+	adcsra = (adcsra & ~(1 << ADSC)) | (1 << ADIF);
+	mock_adc_conversions++;
+}
+
+volatile uint8_t *mock_adcsra(void) {
+	if ((adcsra & (1 << ADEN)) && (adcsra & (1 << ADSC)))
+		mock_adc_convert();
+	return (&adcsra);
+}
+
+void mock_interrupts(void) {
+	static _Bool dispatching = 0;
+	if (dispatching)
+		return;
+	dispatching = 1;
+	while (SREG & (1 << SREG_I)) {
+		if (fake_i2c_pending()) {
+			run_vector(TWI_vect);
+		} else if (mock_uart_auto && (uart_shift(), !mock_uart_busy) && (UCSR0B & (1 << UDRIE0))) {
+			run_vector(USART_UDRE_vect);
+		} else if (mock_uart_input && *mock_uart_input && (UCSR0B & (1 << RXCIE0))) {
+			//One character at a time, the CPU is much faster than the line
+			mock_uart_receive(*mock_uart_input++);
+			break;
+		} else {
+			break;
+		}
+	}
+	dispatching = 0;
+}
+
+void mock_vector(void (*vector)(void)) {
+	run_vector(vector);
+	mock_interrupts();
+}
+
+void mock_delay_us(double us) {
+	mock_time_us += (uint32_t) us;
+	if (mock_delay_hook)
+		mock_delay_hook();
+}
+
+static sigjmp_buf run_jump;
+
+static void run_timeout(int sig) {
+	(void) sig;
+	siglongjmp(run_jump, MOCK_RUN_SPINNING);
+}
+
+int mock_run(int (*entry)(void), unsigned limit_ms) {
+	struct itimerval timer = {{0, 0}, {limit_ms / 1000, limit_ms % 1000 * 1000}};
+	volatile int ended = sigsetjmp(run_jump, 1);
+	if (!ended) {
+		signal(SIGALRM, run_timeout);
+		setitimer(ITIMER_REAL, &timer, 0);
+		entry();
+		ended = MOCK_RUN_RETURNED;
+	}
+	timer.it_value.tv_sec = 0;
+	timer.it_value.tv_usec = 0;
+	setitimer(ITIMER_REAL, &timer, 0);
+	return (ended);
+}
+
+void mock_stop(void) {
+	siglongjmp(run_jump, MOCK_RUN_STOPPED);
+}
+
+void mock_sleep(void) {
+	//A pending interrupt wakes the CPU at once
+	mock_interrupts();
+	uint8_t mode = (SMCR >> SM0) & 7;
+	mock_sleeps[mode]++;
+	//Entering ADC noise reduction mode starts a conversion
+	if ((SMCR & ((1 << SM2) | (1 << SM1) | (1 << SM0))) == SLEEP_MODE_ADC && (adcsra & (1 << ADEN)))
+		adcsra |= (1 << ADSC);
+	if (mock_sleep_hook)
+		mock_sleep_hook();
+}
+
+void mock_reset(void) {
+	PORTB = 0;
+	DDRB = 0;
+	PINB = 0;
+	PORTC = 0;
+	DDRC = 0;
+	PINC = 0;
+	PORTD = 0;
+	DDRD = 0;
+	PIND = 0;
+	UCSR0B = 0;
+	UCSR0C = 0;
+	TWDR = 0;
+	TWBR = 0;
+	TWAR = 0;
+	TWAMR = 0;
+	SPCR = 0;
+	ADMUX = 0;
+	ADCSRB = 0;
+	DIDR0 = 0;
+	TCCR0A = 0;
+	TCCR0B = 0;
+	TCNT0 = 0;
+	OCR0A = 0;
+	OCR0B = 0;
+	TIMSK0 = 0;
+	TIFR0 = 0;
+	TCCR1A = 0;
+	TCCR1B = 0;
+	TCCR1C = 0;
+	TIMSK1 = 0;
+	TIFR1 = 0;
+	TCCR2A = 0;
+	TCCR2B = 0;
+	TCNT2 = 0;
+	OCR2A = 0;
+	OCR2B = 0;
+	TIMSK2 = 0;
+	TIFR2 = 0;
+	ASSR = 0;
+	EICRA = 0;
+	EIMSK = 0;
+	EIFR = 0;
+	PCICR = 0;
+	PCIFR = 0;
+	PCMSK0 = 0;
+	PCMSK1 = 0;
+	PCMSK2 = 0;
+	SREG = 0;
+	SMCR = 0;
+	MCUCR = 0;
+	MCUSR = 0;
+	PRR = 0;
+	SPMCSR = 0;
+	GTCCR = 0;
+	ACSR = 0;
+	WDTCSR = 0;
+	CLKPR = 0;
+	ADC = 0;
+	OCR1A = 0;
+	OCR1B = 0;
+	TCNT1 = 0;
+	ICR1 = 0;
+	UBRR0 = 0;
+	UDR0 = MOCK_EMPTY;
+	SPDR = MOCK_EMPTY;
+	ucsr0a = 0;
+	spsr = 0;
+	adcsra = 0;
+	receiving = 0;
+	mock_uart_busy = 0;
+	mock_uart_auto = 0;
+	mock_uart_input = 0;
+	mock_uart_len = 0;
+	mock_spi_len = 0;
+	mock_spi_masked = 0;
+	memset(mock_adc_input, 0, sizeof mock_adc_input);
+	mock_adc_conversions = 0;
+	memset(mock_sleeps, 0, sizeof mock_sleeps);
+	mock_sleep_hook = 0;
+	mock_time_us = 0;
+	mock_delay_hook = 0;
+	fake_i2c_reset();
+}
@@ -0,0 +1,83 @@
+#ifndef MOCK_H
+#define MOCK_H
+
+#include <stdint.h>
+#include <avr/io.h>
+
+//Scripted hardware behind the register mocks. mock_reset puts every register
+//back to 0 and the devices in their idle state
+
+//UART: a character written to UDR0 is shifted out at the next UCSR0A access
+//unless mock_uart_busy is set (then UDRE0 and TXC0 stay clear)
+extern _Bool mock_uart_busy;
+//Set to have USART_UDRE_vect run whenever interrupts are on, as on the chip
+extern _Bool mock_uart_auto;
+extern char mock_uart_out[1024];
+extern uint16_t mock_uart_len;
+//Captures a pending character, then runs USART_UDRE_vect while it is enabled
+void mock_uart_drain(void);
+//NUL terminated output so far, then forgets it
+const char *mock_uart_take(void);
+//Receives c through USART_RX_vect
+void mock_uart_receive(char c);
+//Characters received whenever interrupts are on and RXCIE0 is set, one per
+//mock_interrupts call
+extern const char *mock_uart_input;
+
+//SPI: a byte written to SPDR is sent at the next SPSR access, which sets SPIF
+extern uint8_t mock_spi_out[4096];
+extern uint16_t mock_spi_len;
+//Bytes sent with interrupts off, SPI_STC_vect included
+extern uint16_t mock_spi_masked;
+//Runs SPI_STC_vect for every byte while the interrupt is enabled
+void mock_spi_drain(void);
+
+//ADC: a conversion started with ADSC (or by ADC noise reduction sleep) ends at
+//the next ADCSRA access with the 10 bit value of the selected input
+extern uint16_t mock_adc_input[16];
+extern uint16_t mock_adc_conversions;
+//Ends a conversion of the selected input now (for auto triggered ones)
+void mock_adc_convert(void);
+
+//Sleep: counts sleeps by mode (index SLEEP_MODE_* >> SM0) and runs the hook,
+//if any, as the wake-up interrupt
+extern uint16_t mock_sleeps[8];
+extern void (*mock_sleep_hook)(void);
+
+//EEPROM content, kept by mock_reset like on the chip
+extern uint8_t mock_eeprom[1024];
+
+//Delays: time spent in _delay_ms and _delay_us, the hook runs after each one
+extern uint32_t mock_time_us;
+extern void (*mock_delay_hook)(void);
+void mock_delay_us(double us);
+
+//Runs vector as the chip would (interrupts off inside), then the interrupts
+//that became due
+void mock_vector(void (*vector)(void));
+//Runs the due interrupts while interrupts are on: TWI_vect (see fake_i2c.h),
+//USART_UDRE_vect with mock_uart_auto and USART_RX_vect for mock_uart_input.
+//Called by sei, at the end of an ATOMIC_BLOCK, on sleep and on TWI register
+//accesses
+void mock_interrupts(void);
+
+//Exercises: runs the main of an exercise, which never returns, until a hook
+//calls mock_stop or it has spun for limit_ms of host time without stopping
+#define MOCK_RUN_RETURNED 1
+#define MOCK_RUN_STOPPED 2
+#define MOCK_RUN_SPINNING 3
+int mock_run(int (*entry)(void), unsigned limit_ms);
+void mock_stop(void);
+
+//Also resets the TWI hardware and the devices of fake_i2c.h
+void mock_reset(void);
+
+//Vectors of the library sources the tests link
+void USART_UDRE_vect(void);
+void USART_RX_vect(void);
+void SPI_STC_vect(void);
+void ADC_vect(void);
+void TWI_vect(void);
+void TIMER2_COMPA_vect(void);
+
+#endif
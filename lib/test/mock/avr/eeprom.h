@@ -0,0 +1,11 @@
+#ifndef MOCK_AVR_EEPROM_H
+#define MOCK_AVR_EEPROM_H
+
+#include <stdint.h>
+
+//Reads and writes mock_eeprom (see mock.h), writes take no time
+extern uint8_t mock_eeprom[1024];
+#define eeprom_read_byte(addr) ((uint8_t) mock_eeprom[(uintptr_t) (addr) & 1023])
+#define eeprom_write_byte(addr, value) ((void) (mock_eeprom[(uintptr_t) (addr) & 1023] = (value)))
+
+#endif
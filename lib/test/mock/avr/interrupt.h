@@ -0,0 +1,14 @@
+#ifndef MOCK_AVR_INTERRUPT_H
+#define MOCK_AVR_INTERRUPT_H
+
+#include <avr/io.h>
+
+//Vectors become plain functions that the tests call to raise an interrupt
+#define ISR(vector, ...) void vector(void); void vector(void)
+#define EMPTY_INTERRUPT(vector) void vector(void); void vector(void) {}
+//Enabling interrupts runs the ones that are due (see mock.h)
+void mock_interrupts(void);
+#define sei() (SREG |= (1 << SREG_I), mock_interrupts())
+#define cli() (SREG &= ~(1 << SREG_I))
+
+#endif
@@ -0,0 +1,354 @@
+#ifndef MOCK_AVR_IO_H
+#define MOCK_AVR_IO_H
+
+#include <stdint.h>
+
+//Host stand-in for the ATmega328P registers: plain variables, except for the
+//few registers whose side effects the tests script (see mock.h)
+
+extern volatile uint8_t PORTB;
+extern volatile uint8_t DDRB;
+extern volatile uint8_t PINB;
+extern volatile uint8_t PORTC;
+extern volatile uint8_t DDRC;
+extern volatile uint8_t PINC;
+extern volatile uint8_t PORTD;
+extern volatile uint8_t DDRD;
+extern volatile uint8_t PIND;
+extern volatile uint8_t UCSR0B;
+extern volatile uint8_t UCSR0C;
+extern volatile uint8_t TWDR;
+extern volatile uint8_t TWBR;
+extern volatile uint8_t TWAR;
+extern volatile uint8_t TWAMR;
+extern volatile uint8_t SPCR;
+extern volatile uint8_t ADMUX;
+extern volatile uint8_t ADCSRB;
+extern volatile uint8_t DIDR0;
+extern volatile uint8_t TCCR0A;
+extern volatile uint8_t TCCR0B;
+extern volatile uint8_t TCNT0;
+extern volatile uint8_t OCR0A;
+extern volatile uint8_t OCR0B;
+extern volatile uint8_t TIMSK0;
+extern volatile uint8_t TIFR0;
+extern volatile uint8_t TCCR1A;
+extern volatile uint8_t TCCR1B;
+extern volatile uint8_t TCCR1C;
+extern volatile uint8_t TIMSK1;
+extern volatile uint8_t TIFR1;
+extern volatile uint8_t TCCR2A;
+extern volatile uint8_t TCCR2B;
+extern volatile uint8_t TCNT2;
+extern volatile uint8_t OCR2A;
+extern volatile uint8_t OCR2B;
+extern volatile uint8_t TIMSK2;
+extern volatile uint8_t TIFR2;
+extern volatile uint8_t ASSR;
+extern volatile uint8_t EICRA;
+extern volatile uint8_t EIMSK;
+extern volatile uint8_t EIFR;
+extern volatile uint8_t PCICR;
+extern volatile uint8_t PCIFR;
+extern volatile uint8_t PCMSK0;
+extern volatile uint8_t PCMSK1;
+extern volatile uint8_t PCMSK2;
+extern volatile uint8_t SREG;
+extern volatile uint8_t SMCR;
+extern volatile uint8_t MCUCR;
+extern volatile uint8_t MCUSR;
+extern volatile uint8_t PRR;
+extern volatile uint8_t SPMCSR;
+extern volatile uint8_t GTCCR;
+extern volatile uint8_t ACSR;
+extern volatile uint8_t WDTCSR;
+extern volatile uint8_t CLKPR;
+extern volatile uint16_t ADC;
+extern volatile uint16_t OCR1A;
+extern volatile uint16_t OCR1B;
+extern volatile uint16_t TCNT1;
+extern volatile uint16_t ICR1;
+extern volatile uint16_t UBRR0;
+
+//Data registers are 16 bits wide so that MOCK_EMPTY can mark them as read by
+//the fake device, a write is captured on the next status register access
+#define MOCK_EMPTY 0x100
+extern volatile uint16_t UDR0;
+extern volatile uint16_t SPDR;
+volatile uint8_t *mock_ucsr0a(void);
+volatile uint8_t *mock_spsr(void);
+volatile uint8_t *mock_adcsra(void);
+volatile uint8_t *mock_twcr(void);
+volatile uint8_t *mock_twsr(void);
+#define UCSR0A (*mock_ucsr0a())
+#define TWCR (*mock_twcr())
+#define TWSR (*mock_twsr())
+#define SPSR (*mock_spsr())
+#define ADCSRA (*mock_adcsra())
+#define ADCL ((uint8_t) ADC)
+#define ADCH ((uint8_t) (ADC >> 8))
+
+#define _BV(b) (1 << (b))
+#define bit_is_set(r,b) ((r) & _BV(b))
+#define bit_is_clear(r,b) (!((r) & _BV(b)))
+#define loop_until_bit_is_set(r,b) do {} while (bit_is_clear(r,b))
+#define RAMEND 0x8FF
+#define PB0 0
+#define PB1 1
+#define PB2 2
+#define PB3 3
+#define PB4 4
+#define PB5 5
+#define PB6 6
+#define PB7 7
+#define DDB0 0
+#define PINB0 0
+#define PORTB0 0
+#define DDB1 1
+#define PINB1 1
+#define PORTB1 1
+#define DDB2 2
+#define PINB2 2
+#define PORTB2 2
+#define DDB3 3
+#define PINB3 3
+#define PORTB3 3
+#define DDB4 4
+#define PINB4 4
+#define PORTB4 4
+#define DDB5 5
+#define PINB5 5
+#define PORTB5 5
+#define DDB6 6
+#define PINB6 6
+#define PORTB6 6
+#define DDB7 7
+#define PINB7 7
+#define PORTB7 7
+#define DDC0 0
+#define PC0 0
+#define PINC0 0
+#define PORTC0 0
+#define DDC1 1
+#define PC1 1
+#define PINC1 1
+#define PORTC1 1
+#define DDC2 2
+#define PC2 2
+#define PINC2 2
+#define PORTC2 2
+#define DDC3 3
+#define PC3 3
+#define PINC3 3
+#define PORTC3 3
+#define DDC4 4
+#define PC4 4
+#define PINC4 4
+#define PORTC4 4
+#define DDC5 5
+#define PC5 5
+#define PINC5 5
+#define PORTC5 5
+#define DDC6 6
+#define PC6 6
+#define PINC6 6
+#define PORTC6 6
+#define DDC7 7
+#define PC7 7
+#define PINC7 7
+#define PORTC7 7
+#define DDD0 0
+#define PD0 0
+#define PIND0 0
+#define PORTD0 0
+#define DDD1 1
+#define PD1 1
+#define PIND1 1
+#define PORTD1 1
+#define DDD2 2
+#define PD2 2
+#define PIND2 2
+#define PORTD2 2
+#define DDD3 3
+#define PD3 3
+#define PIND3 3
+#define PORTD3 3
+#define DDD4 4
+#define PD4 4
+#define PIND4 4
+#define PORTD4 4
+#define DDD5 5
+#define PD5 5
+#define PIND5 5
+#define PORTD5 5
+#define DDD6 6
+#define PD6 6
+#define PIND6 6
+#define PORTD6 6
+#define DDD7 7
+#define PD7 7
+#define PIND7 7
+#define PORTD7 7
+#define RXC0 7
+#define TXC0 6
+#define UDRE0 5
+#define FE0 4
+#define DOR0 3
+#define UPE0 2
+#define U2X0 1
+#define RXCIE0 7
+#define TXCIE0 6
+#define UDRIE0 5
+#define RXEN0 4
+#define TXEN0 3
+#define UCSZ02 2
+#define UCSZ01 2
+#define UCSZ00 1
+#define TWINT 7
+#define TWEA 6
+#define TWSTA 5
+#define TWSTO 4
+#define TWWC 3
+#define TWEN 2
+#define TWIE 0
+#define TWPS1 1
+#define TWPS0 0
+#define TWGCE 0
+#define SPIE 7
+#define SPE 6
+#define DORD 5
+#define MSTR 4
+#define CPOL 3
+#define CPHA 2
+#define SPR1 1
+#define SPR0 0
+#define SPIF 7
+#define WCOL 6
+#define SPI2X 0
+#define REFS1 7
+#define REFS0 6
+#define ADLAR 5
+#define MUX3 3
+#define MUX2 2
+#define MUX1 1
+#define MUX0 0
+#define ADEN 7
+#define ADSC 6
+#define ADATE 5
+#define ADIF 4
+#define ADIE 3
+#define ADPS2 2
+#define ADPS1 1
+#define ADPS0 0
+#define ADTS2 2
+#define ADTS1 1
+#define ADTS0 0
+#define COM0A1 7
+#define COM0A0 6
+#define COM0B1 5
+#define COM0B0 4
+#define WGM01 1
+#define WGM00 0
+#define WGM02 3
+#define CS02 2
+#define CS01 1
+#define CS00 0
+#define TOIE0 0
+#define OCIE0A 1
+#define OCIE0B 2
+#define TOV0 0
+#define OCF0A 1
+#define OCF0B 2
+#define COM1A1 7
+#define COM1A0 6
+#define COM1B1 5
+#define COM1B0 4
+#define WGM11 1
+#define WGM10 0
+#define ICNC1 7
+#define ICES1 6
+#define WGM13 4
+#define WGM12 3
+#define CS12 2
+#define CS11 1
+#define CS10 0
+#define ICIE1 5
+#define OCIE1B 2
+#define OCIE1A 1
+#define TOIE1 0
+#define ICF1 5
+#define OCF1B 2
+#define OCF1A 1
+#define TOV1 0
+#define COM2A1 7
+#define COM2A0 6
+#define COM2B1 5
+#define COM2B0 4
+#define WGM21 1
+#define WGM20 0
+#define WGM22 3
+#define CS22 2
+#define CS21 1
+#define CS20 0
+#define TOIE2 0
+#define OCIE2A 1
+#define OCIE2B 2
+#define TOV2 0
+#define OCF2A 1
+#define OCF2B 2
+#define ISC11 3
+#define ISC10 2
+#define ISC01 1
+#define ISC00 0
+#define INT1 1
+#define INT0 0
+#define INTF1 1
+#define INTF0 0
+#define PCIE2 2
+#define PCIE1 1
+#define PCIE0 0
+#define PCIF2 2
+#define PCIF1 1
+#define PCIF0 0
+#define SREG_I 7
+#define SELFPRGEN 0
+#define SE 0
+#define SM0 1
+#define SM1 2
+#define SM2 3
+#define PRADC 0
+#define PRUSART0 1
+#define PRSPI 2
+#define PRTIM1 3
+#define PRTIM0 5
+#define PRTIM2 6
+#define PRTWI 7
+#define ADC0D 0
+#define ADC1D 1
+#define ADC2D 2
+#define PCINT0 0
+#define PCINT1 1
+#define PCINT2 2
+#define PCINT3 3
+#define PCINT4 4
+#define PCINT5 5
+#define PCINT6 6
+#define PCINT7 7
+#define PCINT8 0
+#define PCINT9 1
+#define PCINT10 2
+#define PCINT11 3
+#define PCINT12 4
+#define PCINT13 5
+#define PCINT14 6
+#define PCINT15 7
+#define PCINT16 0
+#define PCINT17 1
+#define PCINT18 2
+#define PCINT19 3
+#define PCINT20 4
+#define PCINT21 5
+#define PCINT22 6
+#define PCINT23 7
+
+#endif
@@ -0,0 +1,10 @@
+#ifndef MOCK_AVR_PGMSPACE_H
+#define MOCK_AVR_PGMSPACE_H
+
+#include <stdint.h>
+
+#define PROGMEM
+#define pgm_read_byte(address) (*(const uint8_t *) (address))
+#define pgm_read_word(address) (*(const uint16_t *) (address))
+
+#endif
@@ -0,0 +1,20 @@
+#ifndef MOCK_AVR_SLEEP_H
+#define MOCK_AVR_SLEEP_H
+
+#include <avr/io.h>
+
+#define SLEEP_MODE_IDLE 0
+#define SLEEP_MODE_ADC (1 << SM0)
+#define SLEEP_MODE_PWR_DOWN (1 << SM1)
+#define SLEEP_MODE_PWR_SAVE ((1 << SM1) | (1 << SM0))
+#define SLEEP_MODE_STANDBY ((1 << SM2) | (1 << SM1))
+
+#define set_sleep_mode(mode) (SMCR = (SMCR & ~((1 << SM2) | (1 << SM1) | (1 << SM0))) | (mode))
+#define sleep_enable() (SMCR |= (1 << SE))
+#define sleep_disable() (SMCR &= ~(1 << SE))
+
+//Runs what the tests want to happen while the CPU is asleep (see mock.h)
+void mock_sleep(void);
+#define sleep_cpu() mock_sleep()
+
+#endif
@@ -0,0 +1,27 @@
+#ifndef MOCK_UTIL_ATOMIC_H
+#define MOCK_UTIL_ATOMIC_H
+
+#include <avr/interrupt.h>
+
+//Same construction as avr-libc: the saved SREG is restored by a cleanup
+//handler, so leaving the block with return restores it too
+static inline uint8_t mock_cli_ret(void) {
+	cli();
+	return (1);
+}
+
+static inline void mock_restore(const uint8_t *sreg) {
+	SREG = *sreg;
+	mock_interrupts();
+}
+
+static inline void mock_force_on(const uint8_t *sreg) {
+	(void) sreg;
+	sei();
+}
+
+#define ATOMIC_RESTORESTATE uint8_t mock_sreg __attribute__((cleanup(mock_restore))) = SREG
+#define ATOMIC_FORCEON uint8_t mock_sreg __attribute__((cleanup(mock_force_on))) = 0
+#define ATOMIC_BLOCK(type) for (type, mock_todo = mock_cli_ret(); mock_todo; mock_todo = 0)
+
+#endif
@@ -0,0 +1,9 @@
+#ifndef MOCK_UTIL_DELAY_H
+#define MOCK_UTIL_DELAY_H
+
+//Delays take no host time, they are added up in mock_time_us (see mock.h)
+void mock_delay_us(double us);
+#define _delay_ms(ms) mock_delay_us((ms) * 1000.0)
+#define _delay_us(us) mock_delay_us(us)
+
+#endif
@@ -0,0 +1,46 @@
+#ifndef TEST_H
+#define TEST_H
+
+#include <stdio.h>
+#include <string.h>
+
+//Every test program includes this once: checks print what failed and main
+//returns test_report() as its exit status
+
+static int test_checks = 0;
+static int test_failures = 0;
+
+#define CHECK(cond) do { \
+	test_checks++; \
+	if (!(cond)) { \
+		test_failures++; \
+		printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+	} \
+} while (0)
+
+#define CHECK_EQ(actual, expected) do { \
+	long test_actual = (long) (actual); \
+	long test_expected = (long) (expected); \
+	test_checks++; \
+	if (test_actual != test_expected) { \
+		test_failures++; \
+		printf("%s:%d: %s is %ld, expected %ld\n", __FILE__, __LINE__, #actual, test_actual, test_expected); \
+	} \
+} while (0)
+
+#define CHECK_STR(actual, expected) do { \
+	const char *test_actual = (actual); \
+	const char *test_expected = (expected); \
+	test_checks++; \
+	if (strcmp(test_actual, test_expected)) { \
+		test_failures++; \
+		printf("%s:%d: %s is \"%s\", expected \"%s\"\n", __FILE__, __LINE__, #actual, test_actual, test_expected); \
+	} \
+} while (0)
+
+static inline int test_report(const char *name) {
+	printf("%s: %d checks, %d failed\n", name, test_checks, test_failures);
+	return (test_failures != 0);
+}
+
+#endif
@@ -0,0 +1,67 @@
+#include "mock.h"
+#include "test.h"
+
+#define main exercise_main
+#include "../../3/ex04/main.c"
+#undef main
+
+#define LEDS ((1 << PB0) | (1 << PB1) | (1 << PB2) | (1 << PB4))
+
+//LEDs at each step of the animation
+static uint8_t frames[16];
+static uint8_t frame_count;
+
+static void record_leds() {
+	if (frame_count < sizeof frames)
+		frames[frame_count] = PORTB & LEDS;
+	frame_count++;
+}
+
+static void login(const char *input) {
+	mock_reset();
+	mock_uart_auto = 1;
+	mock_uart_input = input;
+	mock_delay_hook = record_leds;
+	frame_count = 0;
+	//Waits for more input once it has answered
+	CHECK_EQ(mock_run(exercise_main, 100), MOCK_RUN_SPINNING);
+	mock_uart_drain();
+}
+
+static void test_success() {
+	static const uint8_t animation[] = {
+		1 << PB0,
+		(1 << PB0) | (1 << PB1),
+		(1 << PB0) | (1 << PB1) | (1 << PB2),
+		LEDS,
+		0, LEDS, 0, LEDS, 0, LEDS, 0
+	};
+	login("maxime\rpassword\r");
+	CHECK_STR(mock_uart_take(), "Enter your login:\r\n\tusername: maxime\r\n"
+		"\tpassword: ********\r\n"
+		"Hello maxime!\r\nShall we play a game\r\n\r\n"
+		"Enter your login:\r\n\tusername: ");
+	CHECK_EQ(DDRB & LEDS, LEDS);
+	CHECK_EQ(frame_count, sizeof animation);
+	CHECK(!memcmp(frames, animation, sizeof animation));
+	CHECK_EQ(mock_time_us, 2750000);
+}
+
+static void test_failure() {
+	//Backspace erases the extra character
+	login("maxime\rpasswordd\x7F\x7F\rmax\x7Fxime\rpassword\r");
+	CHECK_STR(mock_uart_take(), "Enter your login:\r\n\tusername: maxime\r\n"
+		"\tpassword: *********\b \b\b \b\r\n"
+		"Bad combinaison username/password\r\n\r\n"
+		"Enter your login:\r\n\tusername: max\b \bxime\r\n"
+		"\tpassword: ********\r\n"
+		"Hello maxime!\r\nShall we play a game\r\n\r\n"
+		"Enter your login:\r\n\tusername: ");
+	CHECK_EQ(PORTB & LEDS, 0);
+}
+
+int main() {
+	test_success();
+	test_failure();
+	return (test_report("3/ex04"));
+}
@@ -0,0 +1,23 @@
+#include "fake_i2c.h"
+#include "mock.h"
+#include "test.h"
+
+#define main exercise_main
+#include "../../4/ex00/main.c"
+#undef main
+
+int main() {
+	mock_reset();
+	mock_uart_auto = 1;
+	CHECK_EQ(mock_run(exercise_main, 100), MOCK_RUN_SPINNING);
+	mock_uart_drain();
+	//The sensor acknowledged its address, at the speed of its profile
+	CHECK_STR(mock_uart_take(), "0x18\r\n");
+	CHECK_EQ(fake_i2c_nacks, 0);
+	CHECK_EQ(fake_i2c_twbr, I2C_TWBR(I2C_FAST_BAUDRATE));
+	//Stopped: the next start is not a repeated one
+	i2c_start();
+	CHECK_EQ(wait_i2c_ready(), TW_START);
+	i2c_stop();
+	return (test_report("4/ex00"));
+}
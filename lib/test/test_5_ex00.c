@@ -0,0 +1,46 @@
+#include <avr/sleep.h>
+#include "mock.h"
+#include "test.h"
+
+#define main exercise_main
+#include "../../5/ex00/main.c"
+#undef main
+
+#define LEDS ((1 << PB0) | (1 << PB1) | (1 << PB2) | (1 << PB4))
+
+static uint16_t tick;
+
+//Every sleep ends with a timer 2 tick: two presses of SW1, with a bounce
+static void timer2_tick() {
+	if (tick == 120)
+		mock_stop();
+	if (tick == 10 || tick == 12 || tick == 60)
+		PIND &= ~(1 << PD2);
+	if (tick == 11 || tick == 30 || tick == 80)
+		PIND |= (1 << PD2);
+	tick++;
+	mock_vector(TIMER2_COMPA_vect);
+}
+
+int main() {
+	mock_reset();
+	mock_eeprom[0] = 5;
+	PIND = (1 << PD2) | (1 << PD4);
+	mock_sleep_hook = timer2_tick;
+	CHECK_EQ(mock_run(exercise_main, 1000), MOCK_RUN_STOPPED);
+	CHECK_EQ(mock_eeprom[0], 7);
+	CHECK_EQ(n, 7);
+	CHECK_EQ(PORTB & LEDS, (1 << PB0) | (1 << PB1) | (1 << PB2));
+	CHECK_EQ(DDRB & LEDS, LEDS);
+	//Powered down while nothing happens, idle while debouncing
+	CHECK(mock_sleeps[SLEEP_MODE_PWR_DOWN >> SM0]);
+	CHECK(mock_sleeps[SLEEP_MODE_IDLE >> SM0]);
+	//A restart shows the count kept in the EEPROM
+	mock_reset();
+	PIND = (1 << PD2) | (1 << PD4);
+	tick = 100;
+	mock_sleep_hook = timer2_tick;
+	CHECK_EQ(mock_run(exercise_main, 1000), MOCK_RUN_STOPPED);
+	CHECK_EQ(PORTB & LEDS, (1 << PB0) | (1 << PB1) | (1 << PB2));
+	return (test_report("5/ex00"));
+}
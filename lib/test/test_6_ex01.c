@@ -0,0 +1,55 @@
+#include "colour.h"
+#include "mock.h"
+#include "test.h"
+
+#define main exercise_main
+#include "../../6/ex01/main.c"
+#undef main
+
+//Compare values of red (OCR0B), green (OCR0A) and blue (OCR2B) in each second
+static uint8_t steps[16][3];
+static uint8_t step_count;
+
+static void record_colour() {
+	if (step_count < sizeof steps / sizeof *steps) {
+		steps[step_count][0] = OCR0B;
+		steps[step_count][1] = OCR0A;
+		steps[step_count][2] = OCR2B;
+	}
+	step_count++;
+	if (step_count == 8)
+		mock_stop();
+}
+
+int main() {
+	static const uint8_t colours[8][3] = {
+		{255, 0, 0},
+		{0, 255, 0},
+		{0, 0, 255},
+		{255, 255, 0},
+		{0, 255, 255},
+		{255, 0, 255},
+		{255, 255, 255},
+		//And again
+		{255, 0, 0}
+	};
+	mock_reset();
+	mock_delay_hook = record_colour;
+	CHECK_EQ(mock_run(exercise_main, 1000), MOCK_RUN_STOPPED);
+	CHECK_EQ(step_count, 8);
+	CHECK(!memcmp(steps, colours, sizeof colours));
+	CHECK_EQ(mock_time_us, 8000000);
+	//Phase correct PWM on OC0A, OC0B and OC2B without prescaler
+	CHECK_EQ(DDRD, (1 << DDD3) | (1 << DDD5) | (1 << DDD6));
+	CHECK_EQ(TCCR0A, (1 << WGM00) | (1 << COM0A1) | (1 << COM0B1));
+	CHECK_EQ(TCCR0B, 1 << CS00);
+	CHECK_EQ(TCCR2A, (1 << WGM20) | (1 << COM2B1));
+	CHECK_EQ(TCCR2B, 1 << CS20);
+	//Levels in between are gamma corrected
+	set_rgb(128, 64, 1);
+	CHECK_EQ(OCR0B, colour_gamma(128));
+	CHECK_EQ(OCR0A, colour_gamma(64));
+	CHECK_EQ(OCR2B, colour_gamma(1));
+	CHECK(colour_gamma(64) < 64);
+	return (test_report("6/ex01"));
+}
@@ -0,0 +1,39 @@
+#include <avr/sleep.h>
+#include "mock.h"
+#include "test.h"
+
+#define main exercise_main
+#include "../../7/ex00/main.c"
+#undef main
+
+static const uint16_t inputs[] = {0x3FF, 0x000, 0x200, 0x0FF};
+static uint8_t periods;
+
+//Timer 1 wakes the CPU in idle mode, the conversion ends the ADC noise
+//reduction sleep by itself
+static void wake() {
+	if ((SMCR & ((1 << SM2) | (1 << SM1) | (1 << SM0))) != SLEEP_MODE_IDLE)
+		return;
+	if (periods == sizeof inputs / sizeof *inputs)
+		mock_stop();
+	mock_adc_input[0] = inputs[periods++];
+	mock_vector(TIMER1_COMPA_vect);
+}
+
+int main() {
+	mock_reset();
+	mock_uart_auto = 1;
+	mock_sleep_hook = wake;
+	CHECK_EQ(mock_run(exercise_main, 1000), MOCK_RUN_STOPPED);
+	mock_uart_drain();
+	//8 most significant bits of each 20ms sample
+	CHECK_STR(mock_uart_take(), "FF\r\n00\r\n80\r\n3F\r\n");
+	CHECK_EQ(mock_adc_conversions, 4);
+	CHECK_EQ(mock_sleeps[SLEEP_MODE_ADC >> SM0], 4);
+	CHECK_EQ(mock_sleeps[SLEEP_MODE_IDLE >> SM0], 5);
+	//CTC mode at 50Hz from the 256x prescaler
+	CHECK_EQ(TCCR1B, (1 << WGM12) | (1 << CS12));
+	CHECK_EQ(OCR1A, 1250);
+	CHECK(TIMSK1 & (1 << OCIE1A));
+	return (test_report("7/ex00"));
+}
@@ -0,0 +1,29 @@
+#include "mock.h"
+#include "test.h"
+
+#define main exercise_main
+#include "../../8/ex00/main.c"
+#undef main
+
+int main() {
+	static const uint8_t frame[APA102_FRAME_SIZE] = {
+		0, 0, 0, 0,
+		//D6 red at brightness 1, D7 and D8 off
+		APA102_BRIGHTNESS(1), 0, 0, 255,
+		APA102_BRIGHTNESS(0), 0, 0, 0,
+		APA102_BRIGHTNESS(0), 0, 0, 0,
+		0xFF
+	};
+	mock_reset();
+	CHECK_EQ(mock_run(exercise_main, 100), MOCK_RUN_SPINNING);
+	//apa102_update waits for the frame, even with interrupts off
+	CHECK_EQ(mock_spi_len, APA102_FRAME_SIZE);
+	CHECK(!memcmp(mock_spi_out, frame, sizeof frame));
+	//Master at F_CPU / SPI_DIVIDER (16), done with the interrupt
+	CHECK_EQ(SPCR & ~(1 << SPIE), (1 << SPE) | (1 << MSTR) | (1 << SPR0));
+	CHECK(!(SPSR & (1 << SPI2X)));
+	CHECK_EQ(DDRB & ((1 << PB2) | (1 << PB3) | (1 << PB5)), (1 << PB2) | (1 << PB3) | (1 << PB5));
+	mock_spi_drain();
+	CHECK_EQ(mock_spi_len, APA102_FRAME_SIZE);
+	return (test_report("8/ex00"));
+}
@@ -0,0 +1,101 @@
+#include <avr/interrupt.h>
+#include <avr/io.h>
+#include <avr/sleep.h>
+#include "adc.h"
+#include "fake_i2c.h"
+#include "i2c.h"
+#include "mock.h"
+#include "spi.h"
+#include "test.h"
+#include "uart.h"
+
+static void setup(void) {
+	mock_reset();
+	adc_init();
+}
+
+static void test_get_conv() {
+	setup();
+	CHECK(ADCSRA & (1 << ADEN));
+	mock_adc_input[0] = 300;
+	mock_adc_input[3] = 1023;
+	CHECK_EQ(adc_get_conv(), 300);
+	adc_select(3);
+	CHECK_EQ(adc_get_conv(), 1023);
+	//Reference bits are kept
+	CHECK(ADMUX & (1 << REFS0));
+	CHECK_EQ(mock_adc_conversions, 2);
+}
+
+static void test_sleep_conv() {
+	setup();
+	mock_adc_input[0] = 512;
+	CHECK_EQ(adc_sleep_conv(), 512);
+	CHECK_EQ(mock_sleeps[SLEEP_MODE_ADC >> SM0], 1);
+	CHECK_EQ(mock_adc_conversions, 1);
+	CHECK(SREG & (1 << SREG_I));
+}
+
+static void test_sleep_conv_uart_busy() {
+	setup();
+	uart_init();
+	SREG |= (1 << SREG_I);
+	mock_uart_busy = 1;
+	uart_tx('x');
+	mock_adc_input[0] = 42;
+	//Noise reduction would stop the clock of the character being sent
+	CHECK_EQ(adc_sleep_conv(), 42);
+	CHECK_EQ(mock_sleeps[SLEEP_MODE_ADC >> SM0], 0);
+	CHECK(SREG & (1 << SREG_I));
+	mock_uart_busy = 0;
+	mock_uart_drain();
+	CHECK_EQ(adc_sleep_conv(), 42);
+	CHECK_EQ(mock_sleeps[SLEEP_MODE_ADC >> SM0], 1);
+}
+
+static void test_sleep_conv_transfers() {
+	static const uint8_t data[] = {2, 0x30};
+	i2c_xfer xfer = {FAKE_PCF8563_ADDR, data, sizeof data, 0, 0, 0, i2c_xfer_idle};
+	setup();
+	mock_adc_input[0] = 7;
+	//An I2C transaction waiting for TWI_vect (interrupts off)
+	i2c_init(0, 0);
+	CHECK(i2c_queue(&xfer));
+	CHECK_EQ(adc_sleep_conv(), 7);
+	CHECK_EQ(mock_sleeps[SLEEP_MODE_ADC >> SM0], 0);
+	cli();
+	fake_i2c_run();
+	CHECK_EQ(xfer.status, i2c_xfer_done);
+	CHECK_EQ(adc_sleep_conv(), 7);
+	CHECK_EQ(mock_sleeps[SLEEP_MODE_ADC >> SM0], 1);
+	//An SPI frame sent by interrupt
+	cli();
+	spi_master_init();
+	CHECK(spi_send_async(data, sizeof data, 0));
+	CHECK_EQ(adc_sleep_conv(), 7);
+	CHECK_EQ(mock_sleeps[SLEEP_MODE_ADC >> SM0], 1);
+	mock_spi_drain();
+	CHECK(!spi_async_busy());
+	CHECK_EQ(adc_sleep_conv(), 7);
+	CHECK_EQ(mock_sleeps[SLEEP_MODE_ADC >> SM0], 2);
+}
+
+static void test_oversample() {
+	setup();
+	mock_adc_input[0] = 300;
+	//16 samples of 300 summed then shifted by 2: 12 bits
+	CHECK_EQ(adc_oversample(2), 1200);
+	CHECK_EQ(mock_adc_conversions, 16);
+	mock_adc_input[0] = 1023;
+	CHECK_EQ(adc_oversample(3), 8184);
+}
+
+int main() {
+	test_get_conv();
+	test_sleep_conv();
+	//First: once the UART has sent, mock_reset clears the TXC0 that tells it is idle
+	test_sleep_conv_transfers();
+	test_sleep_conv_uart_busy();
+	test_oversample();
+	return (test_report("adc"));
+}
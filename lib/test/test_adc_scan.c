@@ -0,0 +1,112 @@
+#include <avr/io.h>
+#include <avr/sleep.h>
+#include "adc.h"
+#include "adc_scan.h"
+#include "mock.h"
+#include "test.h"
+
+static const adc_channel channels[2] = {
+	{0, ADC_REF_AVCC, 0, 0},
+	//Different settings, settles for 2 conversions
+	{1, ADC_REF_AVCC, 1, 2}
+};
+
+//A trigger: the first conversion ends, then the ones ADC_vect starts by hand
+//end at the next ADCSRA access
+static void run_scan(void) {
+	mock_adc_convert();
+	ADC_vect();
+	uint16_t n = mock_adc_conversions;
+	while ((void) ADCSRA, mock_adc_conversions != n) {
+		n = mock_adc_conversions;
+		ADC_vect();
+	}
+}
+
+static void setup(void) {
+	mock_reset();
+	adc_init();
+	mock_adc_input[0] = 100;
+	mock_adc_input[1] = 200;
+}
+
+static void test_init() {
+	static const adc_channel many[ADC_SCAN_CHANNELS + 1];
+	setup();
+	CHECK_EQ(adc_scan_init(many, ADC_SCAN_CHANNELS + 1, ADC_TRIGGER_TIMER0_COMPA), 0);
+	CHECK_EQ(adc_scan_init(many, 0, ADC_TRIGGER_TIMER0_COMPA), 0);
+	CHECK(!(ADCSRA & (1 << ADATE)));
+	CHECK_EQ(adc_scan_init(channels, 2, ADC_TRIGGER_TIMER0_COMPA), 1);
+	CHECK(ADCSRA & (1 << ADATE));
+	CHECK(ADCSRA & (1 << ADIE));
+	CHECK_EQ(ADCSRB & 7, ADC_TRIGGER_TIMER0_COMPA);
+}
+
+static void test_scan() {
+	adc_sample sample;
+	setup();
+	adc_scan_init(channels, 2, ADC_TRIGGER_TIMER0_COMPA);
+	CHECK(!adc_scan_read(0, &sample));
+	run_scan();
+	//One conversion for entry 0, 2 discarded then 1 for entry 1
+	CHECK_EQ(mock_adc_conversions, 4);
+	//Back on the first entry, the trigger flag cleared for the next scan
+	CHECK_EQ(ADMUX & 0x0F, 0);
+	CHECK(TIFR0 & (1 << OCF0A));
+	CHECK(adc_scan_read(0, &sample));
+	CHECK_EQ(sample.value, 100);
+	CHECK_EQ(sample.scan, 0);
+	CHECK(adc_scan_read(1, &sample));
+	CHECK_EQ(sample.value, 200 << 6);
+	CHECK_EQ(sample.scan, 0);
+	CHECK(!adc_scan_read(1, &sample));
+	mock_adc_input[0] = 101;
+	run_scan();
+	mock_adc_input[0] = 102;
+	run_scan();
+	CHECK(adc_scan_latest(0, &sample));
+	CHECK_EQ(sample.value, 102);
+	CHECK_EQ(sample.scan, 2);
+	CHECK(!adc_scan_read(0, &sample));
+	CHECK(adc_scan_read(1, &sample));
+	CHECK_EQ(sample.scan, 1);
+}
+
+static void test_overflow() {
+	adc_sample sample;
+	setup();
+	adc_scan_init(channels, 2, ADC_TRIGGER_TIMER0_COMPA);
+	uint16_t overflows = adc_scan_get_overflows();
+	for (uint8_t i = 0; i < ADC_SCAN_BUFFER_SIZE; i++)
+		run_scan();
+	//One slot of each ring stays free
+	CHECK_EQ(adc_scan_get_overflows() - overflows, 2);
+	//The last scan is the one dropped
+	CHECK(adc_scan_read(0, &sample));
+	uint16_t first = sample.scan;
+	for (uint8_t i = 1; i < ADC_SCAN_BUFFER_SIZE - 1; i++) {
+		CHECK(adc_scan_read(0, &sample));
+		CHECK_EQ(sample.scan - first, i);
+	}
+	CHECK(!adc_scan_read(0, &sample));
+}
+
+static void test_wait() {
+	setup();
+	adc_scan_init(channels, 2, ADC_TRIGGER_TIMER0_COMPA);
+	//The scan ends while the CPU sleeps
+	mock_sleep_hook = run_scan;
+	adc_scan_wait(1);
+	CHECK_EQ(mock_sleeps[SLEEP_MODE_IDLE >> SM0], 1);
+	adc_scan_wait(1);
+	CHECK_EQ(mock_sleeps[SLEEP_MODE_IDLE >> SM0], 1);
+	CHECK(SREG & (1 << SREG_I));
+}
+
+int main() {
+	test_init();
+	test_scan();
+	test_overflow();
+	test_wait();
+	return (test_report("adc_scan"));
+}
@@ -0,0 +1,104 @@
+#include <stdlib.h>
+#include "aht20.h"
+#include "fake_i2c.h"
+#include "mock.h"
+#include "test.h"
+
+//Measurement bytes as the sensor sends them
+static void pack(uint8_t *data, uint32_t humidity, uint32_t temp) {
+	data[0] = AHT20_CALIBRATED;
+	data[1] = humidity >> 12;
+	data[2] = humidity >> 4;
+	data[3] = ((humidity & 0x0F) << 4) | ((temp >> 16) & 0x0F);
+	data[4] = temp >> 8;
+	data[5] = temp;
+}
+
+static long nearest(double x) {
+	return (x < 0 ? (long) (x - 0.5) : (long) (x + 0.5));
+}
+
+static void test_decode() {
+	uint8_t data[AHT20_DATA_SIZE];
+	aht20_reading reading;
+	//Half scale: 50%, 50C, 122F
+	pack(data, 0x80000, 0x80000);
+	aht20_decode(data, &reading);
+	CHECK_EQ(reading.humidity, 5000);
+	CHECK_EQ(reading.temp_c, 5000);
+	CHECK_EQ(reading.temp_f, 12200);
+	pack(data, 0, 0);
+	aht20_decode(data, &reading);
+	CHECK_EQ(reading.humidity, 0);
+	CHECK_EQ(reading.temp_c, -5000);
+	CHECK_EQ(reading.temp_f, -5800);
+	//Against the datasheet formulas over the whole range
+	int failures = 0;
+	for (uint32_t raw = 0; raw < (1ul << 20); raw += 4099) {
+		double ratio = raw / 1048576.0;
+		pack(data, raw, 0xFFFFF - raw);
+		aht20_decode(data, &reading);
+		double temp = (0xFFFFF - raw) / 1048576.0;
+		if (labs(reading.humidity - nearest(ratio * 10000)) > 1
+			|| labs(reading.temp_c - nearest(temp * 20000 - 5000)) > 1
+			|| labs(reading.temp_f - nearest(temp * 36000 - 5800)) > 1)
+			failures++;
+	}
+	CHECK_EQ(failures, 0);
+}
+
+#define MEASURE_TICKS ((80 + AHT20_TICK_MS - 1) / AHT20_TICK_MS)
+#define PERIOD_TICKS (AHT20_PERIOD_MS / AHT20_TICK_MS)
+
+//A tick, then the TWI interrupt runs what it queued
+static void tick(uint16_t n) {
+	while (n--) {
+		aht20_sampler_tick();
+		fake_i2c_run();
+	}
+}
+
+static void test_sampler() {
+	aht20_reading reading;
+	fake_sensor.raw_humidity = 0x80000;
+	fake_sensor.raw_temp = 0x80000;
+	CHECK(!aht20_get(&reading));
+	//The first tick triggers a measurement, read back after 80ms
+	tick(1);
+	CHECK_EQ(fake_sensor.triggers, 1);
+	tick(MEASURE_TICKS - 1);
+	CHECK_EQ(fake_sensor.reads, 0);
+	CHECK(!aht20_get(&reading));
+	tick(1);
+	CHECK_EQ(fake_sensor.reads, 1);
+	CHECK(aht20_get(&reading));
+	CHECK_EQ(reading.humidity, 5000);
+	CHECK_EQ(reading.time, MEASURE_TICKS + 1);
+	CHECK_EQ(aht20_ticks(), MEASURE_TICKS + 1);
+	//Next one a period after the trigger, still busy at the first read
+	fake_sensor.busy_reads = 1;
+	fake_sensor.raw_humidity = 0x40000;
+	tick(PERIOD_TICKS - MEASURE_TICKS - 1);
+	CHECK_EQ(fake_sensor.triggers, 1);
+	tick(1);
+	CHECK_EQ(fake_sensor.triggers, 2);
+	tick(MEASURE_TICKS);
+	CHECK_EQ(fake_sensor.reads, 2);
+	CHECK(aht20_get(&reading));
+	CHECK_EQ(reading.humidity, 5000);
+	//Read again on the next tick
+	tick(1);
+	CHECK_EQ(fake_sensor.reads, 3);
+	CHECK(aht20_get(&reading));
+	CHECK_EQ(reading.humidity, 2500);
+	CHECK_EQ(fake_sensor.triggers, 2);
+}
+
+int main() {
+	mock_reset();
+	fake_i2c_reset();
+	test_decode();
+	test_sampler();
+	CHECK_EQ(fake_i2c_nacks, 0);
+	return (test_report("aht20"));
+}
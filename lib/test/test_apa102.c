@@ -0,0 +1,224 @@
+#include "apa102.h"
+#include "colour.h"
+#include "mock.h"
+#include "spi.h"
+#include "test.h"
+
+#define STRING(x) #x
+#define NAME(count) "apa102 (" STRING(count) " LEDs)"
+
+//Built with the default chain, with APA102_LED_COUNT=40, which needs a 3 byte
+//end frame, and with 300, which only has room for one buffer
+
+//Checks the frame sent from offset start of the SPI output: start frame, one
+//frame per LED as given by led, end frame of 1s
+static void check_frame(uint16_t start, void (*led)(uint16_t i, uint8_t *expected)) {
+	uint8_t expected[4];
+	int failures = 0;
+	const uint8_t *out = mock_spi_out + start;
+	CHECK(mock_spi_len - start >= APA102_FRAME_SIZE);
+	for (uint8_t i = 0; i < 4; i++) {
+		if (out[i])
+			failures++;
+	}
+	for (uint16_t i = 0; i < APA102_LED_COUNT; i++) {
+		led(i, expected);
+		for (uint8_t j = 0; j < 4; j++) {
+			if (out[4 + 4 * i + j] != expected[j])
+				failures++;
+		}
+	}
+	for (uint8_t i = 0; i < APA102_END_SIZE; i++) {
+		if (out[4 + 4 * APA102_LED_COUNT + i] != 255)
+			failures++;
+	}
+	CHECK_EQ(failures, 0);
+}
+
+static void led_off(uint16_t i, uint8_t *expected) {
+	(void) i;
+	expected[0] = APA102_BRIGHTNESS(0);
+	expected[1] = 0;
+	expected[2] = 0;
+	expected[3] = 0;
+}
+
+//LED i drawn with r = i, g = 255 - i, b = 128 and brightness i & 31
+static void led_drawn(uint16_t i, uint8_t *expected) {
+	expected[0] = APA102_BRIGHTNESS(i & 31);
+	expected[1] = colour_gamma(128);
+	expected[2] = colour_gamma(255 - i);
+	expected[3] = colour_gamma(i);
+}
+
+static void led_red0_green1(uint16_t i, uint8_t *expected) {
+	led_off(i, expected);
+	if (i == 0)
+		expected[3] = 255;
+	if (i == 1)
+		expected[2] = 255;
+}
+
+static void led_red0(uint16_t i, uint8_t *expected) {
+	led_red0_green1(i, expected);
+	if (i == 1)
+		expected[2] = 0;
+}
+
+static void led_white(uint16_t i, uint8_t *expected) {
+	led_off(i, expected);
+	expected[1] = 255;
+	expected[2] = 255;
+	expected[3] = 255;
+}
+
+static void test_sizes() {
+	CHECK_EQ(apa102_led_count, APA102_LED_COUNT);
+	CHECK_EQ(APA102_END_SIZE * 16 >= APA102_LED_COUNT, 1);
+	CHECK_EQ((APA102_END_SIZE - 1) * 16 < APA102_LED_COUNT, 1);
+	CHECK_EQ(APA102_FRAME_SIZE, 4 + 4 * APA102_LED_COUNT + APA102_END_SIZE);
+}
+
+static void test_layout() {
+	mock_spi_len = 0;
+	apa102_show();
+	mock_spi_drain();
+	CHECK_EQ(mock_spi_len, APA102_FRAME_SIZE);
+	check_frame(0, led_off);
+	for (uint16_t i = 0; i < APA102_LED_COUNT; i++) {
+		apa102_set_rgb(i, i, 255 - i, 128);
+		apa102_set_brightness(i, i & 31);
+	}
+	//Past the end of the chain: ignored
+	apa102_set_rgb(APA102_LED_COUNT, 255, 255, 255);
+	apa102_set_brightness(APA102_LED_COUNT, 31);
+	mock_spi_len = 0;
+	apa102_show();
+	mock_spi_drain();
+	CHECK_EQ(mock_spi_len, APA102_FRAME_SIZE);
+	check_frame(0, led_drawn);
+	CHECK(!spi_async_busy());
+}
+
+static void clear() {
+	apa102_set_all(0, 0, 0);
+	for (uint16_t i = 0; i < APA102_LED_COUNT; i++)
+		apa102_set_brightness(i, 0);
+	apa102_show();
+	mock_spi_drain();
+	mock_spi_len = 0;
+}
+
+#ifndef APA102_SINGLE_BUFFER
+static void test_pending() {
+	clear();
+	apa102_set_rgb(0, 255, 0, 0);
+	apa102_show();
+	CHECK(spi_async_busy());
+	//Drawn and committed during the frame: sent once it is over
+	apa102_set_rgb(1, 0, 255, 0);
+	apa102_show();
+	apa102_show();
+	mock_spi_drain();
+	CHECK_EQ(mock_spi_len, 2 * APA102_FRAME_SIZE);
+	check_frame(0, led_red0);
+	//Drawn on top of the previous commit
+	check_frame(APA102_FRAME_SIZE, led_red0_green1);
+	CHECK(!spi_async_busy());
+}
+#else
+static void test_pending() {
+	clear();
+	apa102_set_rgb(0, 255, 0, 0);
+	apa102_show();
+	CHECK(spi_async_busy());
+	//The frame is sent from the buffer drawn in: the draw waits for it
+	apa102_set_rgb(1, 0, 255, 0);
+	CHECK(!spi_async_busy());
+	CHECK_EQ(mock_spi_len, APA102_FRAME_SIZE);
+	check_frame(0, led_red0);
+	apa102_show();
+	CHECK(spi_async_busy());
+	//So does the next commit, each one is sent
+	apa102_show();
+	mock_spi_drain();
+	CHECK_EQ(mock_spi_len, 3 * APA102_FRAME_SIZE);
+	check_frame(APA102_FRAME_SIZE, led_red0_green1);
+	check_frame(2 * APA102_FRAME_SIZE, led_red0_green1);
+	CHECK(!spi_async_busy());
+}
+#endif
+
+static void test_show_again() {
+	clear();
+	apa102_set_rgb(0, 255, 0, 0);
+	apa102_set_rgb(1, 0, 255, 0);
+	apa102_show();
+	mock_spi_drain();
+	//Nothing drawn since: the same frame is sent again
+	apa102_show();
+	mock_spi_drain();
+	CHECK_EQ(mock_spi_len, 2 * APA102_FRAME_SIZE);
+	check_frame(0, led_red0_green1);
+	check_frame(APA102_FRAME_SIZE, led_red0_green1);
+}
+
+static void test_set_all() {
+	clear();
+	apa102_set_all(255, 255, 255);
+	mock_spi_drain();
+	CHECK_EQ(mock_spi_len, APA102_FRAME_SIZE);
+	check_frame(0, led_white);
+}
+
+static void test_update_interrupts_off() {
+	clear();
+	apa102_set_rgb(0, 255, 0, 0);
+	SREG &= ~(1 << SREG_I);
+	//Nothing runs SPI_STC_vect: the frame is sent by hand
+	apa102_update();
+	CHECK_EQ(mock_spi_len, APA102_FRAME_SIZE);
+	check_frame(0, led_red0);
+	CHECK(!spi_async_busy());
+	SREG |= (1 << SREG_I);
+}
+
+static void test_polled() {
+	spi_set_clock(4);
+	clear();
+	apa102_set_rgb(0, 255, 0, 0);
+	mock_spi_masked = 0;
+	//Sent before apa102_show returns, with interrupts left on
+	apa102_show();
+	CHECK(!spi_async_busy());
+	CHECK_EQ(mock_spi_len, APA102_FRAME_SIZE);
+	CHECK_EQ(mock_spi_masked, 0);
+	check_frame(0, led_red0);
+	//From an interrupt the frame goes through SPI_STC_vect instead
+	SREG &= ~(1 << SREG_I);
+	apa102_show();
+	CHECK(spi_async_busy());
+	mock_spi_drain();
+	SREG |= (1 << SREG_I);
+	CHECK_EQ(mock_spi_len, 2 * APA102_FRAME_SIZE);
+	check_frame(APA102_FRAME_SIZE, led_red0);
+	spi_set_clock(SPI_DIVIDER);
+}
+
+int main() {
+	mock_reset();
+	spi_master_init();
+	test_sizes();
+	test_layout();
+	//The mock only runs SPI_STC_vect from mock_spi_drain: a single buffer
+	//waits for the frame with interrupts off, stepping it by hand
+#ifndef APA102_SINGLE_BUFFER
+	SREG |= (1 << SREG_I);
+#endif
+	test_pending();
+	test_show_again();
+	test_set_all();
+	test_update_interrupts_off();
+	test_polled();
+	return (test_report(NAME(APA102_LED_COUNT)));
+}
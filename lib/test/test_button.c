@@ -0,0 +1,137 @@
+#include <avr/io.h>
+#include "button.h"
+#include "mock.h"
+#include "test.h"
+
+static uint16_t expander = 0xFFFF;
+static button_event events[16];
+static uint8_t event_count;
+
+static uint16_t read_expander() {
+	return (expander);
+}
+
+static void record(button_event event) {
+	if (event_count < sizeof events / sizeof *events)
+		events[event_count] = event;
+	event_count++;
+}
+
+//Both buttons released (pulled up)
+static void setup(void) {
+	mock_reset();
+	PIND = (1 << PD2) | (1 << PD4);
+	expander = 0xFFFF;
+	event_count = 0;
+}
+
+static void ticks(uint16_t n) {
+	while (n--)
+		button_tick();
+}
+
+static void test_debounce() {
+	button_event event;
+	setup();
+	button_init(0, 0);
+	ticks(8);
+	CHECK(button_idle());
+	//A bounce shorter than the debounce is ignored
+	PIND &= ~(1 << PD2);
+	ticks(BUTTON_DEBOUNCE_SAMPLES - 1);
+	PIND |= (1 << PD2);
+	ticks(1);
+	CHECK(!button_poll(&event));
+	CHECK(!button_is_down(button_sw1));
+	CHECK(!button_idle());
+	PIND &= ~(1 << PD2);
+	ticks(BUTTON_DEBOUNCE_SAMPLES - 1);
+	CHECK(!button_poll(&event));
+	ticks(1);
+	CHECK(button_poll(&event));
+	CHECK_EQ(event.button, button_sw1);
+	CHECK_EQ(event.type, button_press);
+	CHECK(button_is_down(button_sw1));
+	PIND |= (1 << PD2);
+	ticks(BUTTON_DEBOUNCE_SAMPLES);
+	CHECK(button_poll(&event));
+	CHECK_EQ(event.type, button_release);
+	CHECK(!button_poll(&event));
+	//Idle once the whole history is quiet
+	CHECK(!button_idle());
+	ticks(8 - BUTTON_DEBOUNCE_SAMPLES);
+	CHECK(button_idle());
+}
+
+static void test_long_press() {
+	button_event event;
+	setup();
+	button_init(0, 0);
+	PIND &= ~(1 << PD4);
+	ticks(BUTTON_DEBOUNCE_SAMPLES);
+	CHECK(button_poll(&event));
+	CHECK_EQ(event.button, button_sw2);
+	CHECK_EQ(event.type, button_press);
+	ticks(BUTTON_LONG_MS / BUTTON_TICK_MS - 1);
+	CHECK(!button_poll(&event));
+	ticks(1);
+	CHECK(button_poll(&event));
+	CHECK_EQ(event.type, button_long_press);
+	for (uint8_t i = 0; i < 3; i++) {
+		ticks(BUTTON_REPEAT_MS / BUTTON_TICK_MS - 1);
+		CHECK(!button_poll(&event));
+		ticks(1);
+		CHECK(button_poll(&event));
+		CHECK_EQ(event.type, button_repeat);
+	}
+	PIND |= (1 << PD4);
+	ticks(8);
+	CHECK(button_poll(&event));
+	CHECK_EQ(event.type, button_release);
+	CHECK(button_idle());
+}
+
+static void test_handler_and_expander() {
+	setup();
+	button_init(read_expander, record);
+	//Only bit 0 of the expander is SW3
+	expander = 0xFFFE;
+	ticks(BUTTON_DEBOUNCE_SAMPLES);
+	CHECK_EQ(event_count, 1);
+	CHECK_EQ(events[0].button, button_sw3);
+	CHECK_EQ(events[0].type, button_press);
+	//Events went to the handler, not the queue
+	CHECK(!button_idle());
+	expander = 0xFFFF;
+	ticks(8);
+	CHECK_EQ(event_count, 2);
+	CHECK_EQ(events[1].type, button_release);
+	CHECK(button_idle());
+}
+
+static void test_overflow() {
+	button_event event;
+	setup();
+	button_init(0, 0);
+	uint16_t overflows = button_get_overflows();
+	for (uint8_t i = 0; i < BUTTON_QUEUE_SIZE; i++) {
+		PIND &= ~(1 << PD2);
+		ticks(BUTTON_DEBOUNCE_SAMPLES);
+		PIND |= (1 << PD2);
+		ticks(BUTTON_DEBOUNCE_SAMPLES);
+	}
+	CHECK_EQ(button_get_overflows() - overflows, BUTTON_QUEUE_SIZE + 1);
+	for (uint8_t i = 0; i < BUTTON_QUEUE_SIZE - 1; i++) {
+		CHECK(button_poll(&event));
+		CHECK_EQ(event.type, i & 1 ? button_release : button_press);
+	}
+	CHECK(!button_poll(&event));
+}
+
+int main() {
+	test_debounce();
+	test_long_press();
+	test_handler_and_expander();
+	test_overflow();
+	return (test_report("button"));
+}
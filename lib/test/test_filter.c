@@ -0,0 +1,122 @@
+#include <stdlib.h>
+#include "filter.h"
+#include "test.h"
+
+static int compare(const void *a, const void *b) {
+	return (*(const uint16_t *) a - *(const uint16_t *) b);
+}
+
+//Median of the last taps samples by sorting them
+static uint16_t sorted_median(const uint16_t *samples, uint8_t taps) {
+	uint16_t window[5];
+	for (uint8_t i = 0; i < taps; i++)
+		window[i] = samples[i];
+	qsort(window, taps, sizeof *window, compare);
+	return (window[taps / 2]);
+}
+
+//Every window of values 0-5 (ties included), then random streams
+static void test_median(uint8_t taps) {
+	int failures = 0;
+	uint16_t samples[5];
+	uint32_t windows = 1;
+	for (uint8_t i = 0; i < taps; i++)
+		windows *= 6;
+	for (uint32_t w = 0; w < windows; w++) {
+		filter_median f = FILTER_MEDIAN(taps);
+		uint32_t n = w;
+		uint16_t out = 0;
+		for (uint8_t i = 0; i < taps; i++) {
+			samples[i] = n % 6;
+			n /= 6;
+			out = filter_median_step(&f, samples[i]);
+		}
+		if (out != sorted_median(samples, taps))
+			failures++;
+	}
+	srand(taps);
+	uint16_t stream[1000];
+	filter_median f = FILTER_MEDIAN(taps);
+	for (uint16_t i = 0; i < 1000; i++) {
+		stream[i] = rand() & 0x3FF;
+		uint16_t out = filter_median_step(&f, stream[i]);
+		if (i + 1 >= taps && out != sorted_median(stream + i + 1 - taps, taps))
+			failures++;
+	}
+	CHECK_EQ(failures, 0);
+	//Primed with the first sample, a single spike is removed
+	filter_median spike = FILTER_MEDIAN(taps);
+	CHECK_EQ(filter_median_step(&spike, 100), 100);
+	CHECK_EQ(filter_median_step(&spike, 1023), 100);
+	CHECK_EQ(filter_median_step(&spike, 100), 100);
+}
+
+static void test_ema() {
+	filter_ema f = FILTER_EMA(3);
+	CHECK_EQ(filter_ema_step(&f, 500), 500);
+	uint16_t out = 0;
+	for (uint8_t i = 0; i < 100; i++)
+		out = filter_ema_step(&f, 1023);
+	CHECK_EQ(out, 1023);
+	for (uint8_t i = 0; i < 100; i++)
+		out = filter_ema_step(&f, 0);
+	CHECK_EQ(out, 0);
+	//Largest shift for 10 bits does not overflow
+	filter_ema wide = FILTER_EMA(6);
+	filter_ema_step(&wide, 0);
+	for (uint16_t i = 0; i < 2000; i++)
+		out = filter_ema_step(&wide, 1023);
+	CHECK_EQ(out, 1023);
+	//Half way after 2^shift * ln 2 steps
+	filter_ema half = FILTER_EMA(3);
+	filter_ema_step(&half, 0);
+	for (uint8_t i = 0; i < 6; i++)
+		out = filter_ema_step(&half, 1000);
+	CHECK(out > 450 && out < 600);
+}
+
+static void test_hysteresis() {
+	filter_hysteresis f = FILTER_HYSTERESIS(2, 1023);
+	CHECK_EQ(filter_hysteresis_step(&f, 500), 500);
+	CHECK_EQ(filter_hysteresis_step(&f, 502), 500);
+	CHECK_EQ(filter_hysteresis_step(&f, 498), 500);
+	CHECK_EQ(filter_hysteresis_step(&f, 503), 503);
+	CHECK_EQ(filter_hysteresis_step(&f, 501), 503);
+	CHECK_EQ(filter_hysteresis_step(&f, 500), 500);
+	//The ends pass through even inside the band
+	CHECK_EQ(filter_hysteresis_step(&f, 2), 2);
+	CHECK_EQ(filter_hysteresis_step(&f, 0), 0);
+	CHECK_EQ(filter_hysteresis_step(&f, 1), 0);
+	CHECK_EQ(filter_hysteresis_step(&f, 1021), 1021);
+	CHECK_EQ(filter_hysteresis_step(&f, 1023), 1023);
+	CHECK_EQ(filter_hysteresis_step(&f, 1022), 1023);
+}
+
+//The 7/ex04 chain: median then EMA on 10 bits, shifted to 8 bits, then
+//hysteresis. A noisy input at either end of the pot reaches 0 and 255
+static void test_chain() {
+	filter_median median = FILTER_MEDIAN(5);
+	filter_ema ema = FILTER_EMA(3);
+	filter_hysteresis hysteresis = FILTER_HYSTERESIS(2, 255);
+	static const int8_t noise[4] = {0, -2, 1, -1};
+	uint16_t out = 0;
+	for (uint16_t i = 0; i < 200; i++) {
+		uint16_t in = 1023 + (noise[i & 3] < 0 ? noise[i & 3] : 0);
+		out = filter_hysteresis_step(&hysteresis, filter_ema_step(&ema, filter_median_step(&median, in)) >> 2);
+	}
+	CHECK_EQ(out, 255);
+	for (uint16_t i = 0; i < 200; i++) {
+		uint16_t in = noise[i & 3] > 0 ? noise[i & 3] : 0;
+		out = filter_hysteresis_step(&hysteresis, filter_ema_step(&ema, filter_median_step(&median, in)) >> 2);
+	}
+	CHECK_EQ(out, 0);
+}
+
+int main() {
+	test_median(3);
+	test_median(5);
+	test_ema();
+	test_hysteresis();
+	test_chain();
+	return (test_report("filter"));
+}
@@ -0,0 +1,65 @@
+#include <stdio.h>
+#include "fmt.h"
+#include "test.h"
+
+//Every value against printf
+
+static void test_dec() {
+	char buf[16];
+	char expected[16];
+	int failures = 0;
+	for (uint32_t n = 0; n <= 0xFFFF; n++) {
+		for (uint8_t width = 0; width <= 8; width++) {
+			uint8_t len = fmt_dec(buf, n, width, ' ');
+			int expected_len = snprintf(expected, sizeof expected, "%*u", width, (unsigned) n);
+			if (strcmp(buf, expected) || len != expected_len)
+				failures++;
+			len = fmt_dec(buf, n, width, '0');
+			expected_len = snprintf(expected, sizeof expected, "%0*u", width, (unsigned) n);
+			if (strcmp(buf, expected) || len != expected_len)
+				failures++;
+		}
+	}
+	CHECK_EQ(failures, 0);
+	fmt_dec(buf, 65535, 0, ' ');
+	CHECK_STR(buf, "65535");
+	fmt_dec(buf, 7, 3, '0');
+	CHECK_STR(buf, "007");
+}
+
+static void test_hex() {
+	char buf[8];
+	char expected[8];
+	int failures = 0;
+	for (uint32_t n = 0; n <= 0xFFFF; n++) {
+		for (uint8_t digits = 1; digits <= 4; digits++) {
+			uint8_t len = fmt_hex(buf, n, digits);
+			snprintf(expected, sizeof expected, "%0*X", digits, (unsigned) (n & ((1ul << (4 * digits)) - 1)));
+			if (strcmp(buf, expected) || len != digits)
+				failures++;
+		}
+	}
+	CHECK_EQ(failures, 0);
+}
+
+static void test_bin() {
+	char buf[9];
+	int failures = 0;
+	for (uint16_t n = 0; n <= 0xFF; n++) {
+		CHECK_EQ(fmt_bin(buf, n), 8);
+		for (uint8_t i = 0; i < 8; i++) {
+			if (buf[i] != ((n >> (7 - i)) & 1) + '0')
+				failures++;
+		}
+		if (buf[8])
+			failures++;
+	}
+	CHECK_EQ(failures, 0);
+}
+
+int main() {
+	test_dec();
+	test_hex();
+	test_bin();
+	return (test_report("fmt"));
+}
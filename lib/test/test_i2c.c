@@ -0,0 +1,176 @@
+#include <avr/io.h>
+#include "aht20.h"
+#include "fake_i2c.h"
+#include "i2c.h"
+#include "mock.h"
+#include "pca9555.h"
+#include "test.h"
+
+static const i2c_profile profiles[] = {
+	I2C_PROFILE(PCA9555_ADDR, I2C_FAST_BAUDRATE)
+};
+
+static uint8_t done_count;
+static i2c_xfer *last_done;
+
+static void on_done(i2c_xfer *xfer) {
+	done_count++;
+	last_done = xfer;
+}
+
+static void setup(void) {
+	mock_reset();
+	i2c_init(profiles, I2C_PROFILE_COUNT(profiles));
+	done_count = 0;
+	last_done = 0;
+}
+
+//Writes the RTC registers from 2 with the blocking functions
+static void write_rtc(const uint8_t *data, uint8_t len) {
+	i2c_start();
+	CHECK_EQ(wait_i2c_ready(), TW_START);
+	i2c_write(FAKE_PCF8563_ADDR | TW_WRITE);
+	CHECK_EQ(wait_i2c_ready(), TW_MT_SLA_ACK);
+	i2c_write(2);
+	for (uint8_t i = 0; i < len; i++)
+		i2c_write(data[i]);
+	CHECK_EQ(wait_i2c_ready(), TW_MT_DATA_ACK);
+	i2c_stop();
+}
+
+static void test_blocking() {
+	static const uint8_t data[] = {0x45, 0x30, 0x12};
+	setup();
+	CHECK(TWCR & (1 << TWEN));
+	write_rtc(data, sizeof data);
+	CHECK_EQ(fake_rtc.regs[2], 0x45);
+	CHECK_EQ(fake_rtc.regs[4], 0x12);
+	//Read back after a repeated start, the last byte is not acknowledged
+	i2c_start();
+	i2c_write(FAKE_PCF8563_ADDR | TW_WRITE);
+	i2c_write(3);
+	wait_i2c_ready();
+	i2c_start();
+	CHECK_EQ(wait_i2c_ready(), TW_REP_START);
+	i2c_write(FAKE_PCF8563_ADDR | TW_READ);
+	CHECK_EQ(wait_i2c_ready(), TW_MR_SLA_ACK);
+	i2c_ack();
+	CHECK_EQ(i2c_read(), 0x30);
+	CHECK_EQ(TW_STATUS, TW_MR_DATA_ACK);
+	i2c_nack();
+	CHECK_EQ(i2c_read(), 0x12);
+	CHECK_EQ(TW_STATUS, TW_MR_DATA_NACK);
+	i2c_stop();
+	//Nobody at that address
+	i2c_start();
+	i2c_write(0x90 | TW_WRITE);
+	CHECK_EQ(wait_i2c_ready(), TW_MT_SLA_NACK);
+	i2c_stop();
+	CHECK_EQ(fake_i2c_nacks, 1);
+}
+
+static void test_speed() {
+	setup();
+	//Default speed for devices without a profile, fast for the expander
+	pca9555_read_input0();
+	CHECK_EQ(fake_i2c_twbr, I2C_TWBR(I2C_FAST_BAUDRATE));
+	CHECK_EQ(fake_i2c_twps, I2C_TWPS(I2C_FAST_BAUDRATE));
+	uint8_t reg = 0;
+	i2c_xfer xfer = {AHT20_ADDR, &reg, 1, 0, 0, 0, i2c_xfer_idle};
+	CHECK(i2c_queue(&xfer));
+	fake_i2c_run();
+	CHECK_EQ(xfer.status, i2c_xfer_done);
+	CHECK_EQ(fake_i2c_twbr, I2C_TWBR(TWI_BAUDRATE));
+	CHECK_EQ(fake_i2c_twps, I2C_TWPS(TWI_BAUDRATE));
+	pca9555_read_input0();
+	CHECK_EQ(fake_i2c_twbr, I2C_TWBR(I2C_FAST_BAUDRATE));
+}
+
+static void test_queue() {
+	static const uint8_t data[] = {2, 0x11, 0x22};
+	uint8_t pointer = 3;
+	uint8_t read[2] = {0, 0};
+	i2c_xfer write = {FAKE_PCF8563_ADDR, data, sizeof data, 0, 0, on_done, i2c_xfer_idle};
+	i2c_xfer readback = {FAKE_PCF8563_ADDR, &pointer, 1, read, 2, on_done, i2c_xfer_idle};
+	setup();
+	//Interrupts off: nothing moves until TWI_vect runs
+	CHECK(i2c_queue(&write));
+	CHECK(i2c_queue(&readback));
+	CHECK(!i2c_queue(&write));
+	CHECK(!i2c_queue_idle());
+	CHECK_EQ(fake_rtc.regs[2], 0);
+	fake_i2c_run();
+	CHECK(i2c_queue_idle());
+	CHECK_EQ(done_count, 2);
+	CHECK_EQ(write.status, i2c_xfer_done);
+	CHECK_EQ(readback.status, i2c_xfer_done);
+	CHECK_EQ(fake_rtc.regs[2], 0x11);
+	CHECK_EQ(read[0], 0x22);
+	//Nothing to write: straight to read mode, from where the pointer is
+	fake_rtc.regs[5] = 0x33;
+	readback.wlen = 0;
+	read[0] = 0;
+	CHECK(i2c_queue(&readback));
+	fake_i2c_run();
+	CHECK_EQ(readback.status, i2c_xfer_done);
+	CHECK_EQ(read[0], 0x33);
+	CHECK_EQ(fake_rtc.pointer, 7);
+	//Nothing to write or read: only the address, a probe
+	i2c_xfer probe = {FAKE_PCF8563_ADDR, 0, 0, 0, 0, on_done, i2c_xfer_idle};
+	CHECK(i2c_queue(&probe));
+	fake_i2c_run();
+	CHECK_EQ(probe.status, i2c_xfer_done);
+	CHECK_EQ(fake_rtc.pointer, 7);
+	probe.addr = 0x90;
+	CHECK(i2c_queue(&probe));
+	CHECK(i2c_queue(&readback));
+	fake_i2c_run();
+	CHECK_EQ(probe.status, i2c_xfer_nack);
+	CHECK_EQ(fake_i2c_nacks, 1);
+	//The stop after the NACK frees the bus for the next one
+	CHECK_EQ(readback.status, i2c_xfer_done);
+	CHECK_EQ(last_done, &readback);
+	CHECK(!(TWCR & (1 << TWSTO)));
+}
+
+static void test_interrupts_on() {
+	static const uint8_t data[] = {2, 0x59};
+	i2c_xfer write = {FAKE_PCF8563_ADDR, data, sizeof data, 0, 0, on_done, i2c_xfer_idle};
+	setup();
+	SREG |= (1 << SREG_I);
+	//TWI_vect runs the transaction as soon as it is queued
+	CHECK(i2c_queue(&write));
+	CHECK_EQ(write.status, i2c_xfer_done);
+	CHECK_EQ(fake_rtc.regs[2], 0x59);
+	CHECK(i2c_queue_idle());
+	i2c_queue_flush();
+	CHECK_EQ(done_count, 1);
+}
+
+static void test_handoff() {
+	static const uint8_t queued[] = {2, 0x01};
+	static const uint8_t blocking[] = {0x02};
+	i2c_xfer write = {FAKE_PCF8563_ADDR, queued, sizeof queued, 0, 0, on_done, i2c_xfer_idle};
+	setup();
+	CHECK(i2c_queue(&write));
+	//The blocking functions wait for the queue (stepped by hand with
+	//interrupts off), then own the bus
+	write_rtc(blocking, sizeof blocking);
+	CHECK_EQ(write.status, i2c_xfer_done);
+	CHECK_EQ(fake_rtc.regs[2], 0x02);
+	//Given back on stop: the queue runs again
+	CHECK(i2c_queue(&write));
+	fake_i2c_run();
+	CHECK_EQ(write.status, i2c_xfer_done);
+	CHECK_EQ(fake_rtc.regs[2], 0x01);
+	CHECK_EQ(done_count, 2);
+}
+
+int main() {
+	test_blocking();
+	test_speed();
+	test_queue();
+	test_interrupts_on();
+	test_handoff();
+	return (test_report("i2c"));
+}
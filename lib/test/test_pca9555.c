@@ -0,0 +1,95 @@
+#include "fake_i2c.h"
+#include "i2c.h"
+#include "mock.h"
+#include "pca9555.h"
+#include "test.h"
+
+static uint16_t changes;
+static uint16_t last_inputs;
+
+static void on_change(uint16_t inputs) {
+	changes++;
+	last_inputs = inputs;
+}
+
+static void test_write() {
+	pca9555_write(PCA9555_CONFIG, 0xFE, 0xFF);
+	CHECK_EQ(fake_expander.regs[6], 0xFE);
+	CHECK_EQ(fake_expander.regs[7], 0xFF);
+	CHECK_EQ(fake_expander.writes, 1);
+	//Same values: nothing is sent
+	pca9555_write(PCA9555_CONFIG, 0xFE, 0xFF);
+	CHECK_EQ(fake_expander.writes, 1);
+	//Only port 1 changed: only port 1 is written
+	fake_expander.regs[6] = 0x55;
+	pca9555_write(PCA9555_CONFIG, 0xFE, 0x00);
+	CHECK_EQ(fake_expander.writes, 2);
+	CHECK_EQ(fake_expander.regs[6], 0x55);
+	CHECK_EQ(fake_expander.regs[7], 0x00);
+	fake_expander.regs[6] = 0xFE;
+}
+
+static void test_bits() {
+	//Output pair not written yet: both ports are sent
+	pca9555_set_bits(PCA9555_OUTPUT, PCA9555_IO1(2));
+	CHECK_EQ(fake_expander.writes, 3);
+	CHECK_EQ(fake_expander.regs[2], 0xFF);
+	CHECK_EQ(fake_expander.regs[3], 0xFF);
+	pca9555_clear_bits(PCA9555_OUTPUT, PCA9555_IO0(3) | PCA9555_IO1(0));
+	CHECK_EQ(fake_expander.regs[2], 0xF7);
+	CHECK_EQ(fake_expander.regs[3], 0xFE);
+	pca9555_set_bits(PCA9555_OUTPUT, PCA9555_IO0(3));
+	CHECK_EQ(fake_expander.regs[2], 0xFF);
+	CHECK_EQ(fake_expander.writes, 5);
+	//Already set
+	pca9555_set_bits(PCA9555_OUTPUT, PCA9555_IO0(3));
+	CHECK_EQ(fake_expander.writes, 5);
+}
+
+static void test_read_input0() {
+	fake_expander.regs[0] = 0xFE;
+	fake_expander.regs[1] = 0x7F;
+	uint16_t reads = fake_expander.reads;
+	CHECK_EQ(pca9555_read_input0(), 0xFE);
+	CHECK_EQ(fake_expander.reads - reads, 1);
+	//Inputs are read only
+	pca9555_write(PCA9555_INPUT, 0, 0);
+	CHECK_EQ(fake_expander.regs[0], 0xFE);
+}
+
+static void test_poll() {
+	fake_expander.regs[0] = 0x12;
+	fake_expander.regs[1] = 0x34;
+	pca9555_input_init(on_change);
+	CHECK_EQ(pca9555_inputs(), 0xFFFF);
+	fake_i2c_run();
+	CHECK_EQ(changes, 1);
+	CHECK_EQ(last_inputs, 0x3412);
+	CHECK_EQ(pca9555_inputs(), 0x3412);
+	//A poll while the read is queued is the same read
+	uint16_t reads = fake_expander.reads;
+	pca9555_poll();
+	pca9555_poll();
+	fake_expander.regs[0] = 0x13;
+	fake_i2c_run();
+	CHECK_EQ(fake_expander.reads - reads, 1);
+	CHECK_EQ(changes, 2);
+	CHECK_EQ(pca9555_inputs(), 0x3413);
+	//A read requested while one is queued is done again after it
+	pca9555_poll();
+	pca9555_input_init(on_change);
+	fake_i2c_run();
+	CHECK_EQ(fake_expander.reads - reads, 3);
+	CHECK(i2c_queue_idle());
+}
+
+int main() {
+	mock_reset();
+	fake_i2c_reset();
+	test_write();
+	test_bits();
+	test_read_input0();
+	test_poll();
+	CHECK_EQ(fake_i2c_nacks, 0);
+	return (test_report("pca9555"));
+}
@@ -0,0 +1,56 @@
+#include "mock.h"
+#include "prof.h"
+#include "test.h"
+#include "uart.h"
+
+enum slots {
+	slot_vector,
+	slot_main
+};
+
+static void test_saturation() {
+	prof_start(1, 0xFFFF);
+	prof_name(slot_vector, "vector");
+	//100 cycles until the count is halved, then 300 as many times
+	for (uint32_t i = 0; i < 0xFFFF; i++) {
+		prof_depth++;
+		prof_record(slot_vector, 1000, 1100, 0);
+	}
+	mock_uart_take();
+	prof_report();
+	mock_uart_drain();
+	CHECK_STR(mock_uart_take(), "vector: n=32767 min=100 avg=100 max=100 overlaps=0\r\n");
+	for (uint32_t i = 0; i < 32767; i++) {
+		prof_depth++;
+		prof_record(slot_vector, 1000, 1300, 0);
+	}
+	prof_report();
+	mock_uart_drain();
+	CHECK_STR(mock_uart_take(), "vector: n=65534 min=100 avg=200 max=300 overlaps=0\r\n");
+	CHECK_EQ(prof_depth, 0);
+}
+
+static void test_main() {
+	prof_reset();
+	prof_name(slot_main, "main");
+	//Not interrupted
+	uint8_t exits = prof_exits;
+	prof_record_main(slot_main, 0, 500, exits);
+	//A vector ran during the section
+	prof_depth++;
+	prof_record(slot_vector, 5000, 5100, 0);
+	prof_record_main(slot_main, 4000, 6000, exits);
+	CHECK_EQ(prof_depth, 0);
+	prof_report();
+	mock_uart_drain();
+	CHECK_STR(mock_uart_take(), "vector: n=1 min=100 avg=100 max=100 overlaps=0\r\n"
+		"main: n=2 min=500 avg=1250 max=2000 overlaps=1\r\n");
+}
+
+int main() {
+	mock_reset();
+	uart_init();
+	test_saturation();
+	test_main();
+	return (test_report("prof"));
+}
@@ -0,0 +1,46 @@
+#include "fake_i2c.h"
+#include "mock.h"
+#include "test.h"
+
+#define main exercise_main
+#include "../../rush1/main.c"
+#undef main
+
+#define CHECK_PAIR(pair, expected) CHECK(!memcmp(pair, expected, 2))
+
+int main() {
+	mock_reset();
+	i2c_init(i2c_profiles, I2C_PROFILE_COUNT(i2c_profiles));
+	//13:59:45 on the 15th of March 2199 (century bit set), a Friday
+	static const uint8_t regs[] = {0x45, 0x59, 0x13, 0x15, 5, 0x83, 0x99};
+	memcpy(&fake_rtc.regs[2], regs, sizeof regs);
+	get_time();
+	CHECK_PAIR(time.sec, "45");
+	CHECK_PAIR(time.min, "59");
+	CHECK_PAIR(time.hour, "13");
+	CHECK_PAIR(time.day, "15");
+	CHECK_PAIR(time.month, "03");
+	CHECK_PAIR(time.year, "99");
+	CHECK(time.century);
+	CHECK_EQ(fake_i2c_twbr, I2C_TWBR(I2C_FAST_BAUDRATE));
+	//15 seconds later, written from the seconds register on
+	for (uint8_t i = 0; i < 15; i++)
+		increment_time();
+	set_time();
+	CHECK_EQ(fake_rtc.regs[2] & 0x7F, 0x00);
+	CHECK_EQ(fake_rtc.regs[3], 0x00);
+	CHECK_EQ(fake_rtc.regs[4], 0x14);
+	CHECK_EQ(fake_rtc.regs[5], 0x15);
+	CHECK_EQ(fake_rtc.regs[7], 0x83);
+	CHECK_EQ(fake_rtc.regs[8], 0x99);
+	//Read back what was written
+	memset(&time, 0, sizeof time);
+	get_time();
+	CHECK_PAIR(time.sec, "00");
+	CHECK_PAIR(time.min, "00");
+	CHECK_PAIR(time.hour, "14");
+	CHECK_PAIR(time.year, "99");
+	CHECK(time.century);
+	CHECK_EQ(fake_i2c_nacks, 0);
+	return (test_report("rush1"));
+}
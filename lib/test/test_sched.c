@@ -0,0 +1,117 @@
+#include <avr/io.h>
+#include <avr/sleep.h>
+#include "mock.h"
+#include "sched.h"
+#include "test.h"
+
+static uint16_t a_runs;
+static uint16_t b_runs;
+static uint16_t c_runs;
+
+static void run_a() {
+	a_runs++;
+}
+
+static void run_b() {
+	b_runs++;
+}
+
+static void run_c() {
+	c_runs++;
+}
+
+static sched_task a = SCHED_TASK("a", run_a);
+static sched_task b = SCHED_TASK("b", run_b);
+static sched_task c = SCHED_TASK("c", run_c);
+
+static void tick_and_run(uint16_t n) {
+	while (n--) {
+		sched_tick();
+		sched_run();
+	}
+}
+
+static void test_timed() {
+	sched_start(&a, 2, 3);
+	CHECK_EQ(sched_run(), 0);
+	tick_and_run(1);
+	CHECK_EQ(a_runs, 0);
+	tick_and_run(1);
+	CHECK_EQ(a_runs, 1);
+	tick_and_run(3);
+	CHECK_EQ(a_runs, 2);
+	tick_and_run(6);
+	CHECK_EQ(a_runs, 4);
+	//Late runs catch up one period per sched_run
+	for (uint8_t i = 0; i < 6; i++)
+		sched_tick();
+	CHECK_EQ(sched_run(), 1);
+	CHECK_EQ(sched_run(), 1);
+	CHECK_EQ(sched_run(), 0);
+	CHECK_EQ(a_runs, 6);
+	sched_stop(&a);
+	tick_and_run(10);
+	CHECK_EQ(a_runs, 6);
+}
+
+static void test_one_shot() {
+	sched_start(&c, 1, 0);
+	tick_and_run(5);
+	CHECK_EQ(c_runs, 1);
+}
+
+static void test_posted() {
+	//Several posts run the task once
+	sched_post(&b);
+	sched_post(&b);
+	CHECK_EQ(sched_run(), 1);
+	CHECK_EQ(b_runs, 1);
+	CHECK_EQ(sched_run(), 0);
+	sched_post(&b);
+	sched_stop(&b);
+	CHECK_EQ(sched_run(), 0);
+	CHECK_EQ(b_runs, 1);
+}
+
+static void test_idle() {
+	uint16_t idle = SLEEP_MODE_IDLE >> SM0;
+	//Nothing to do: sleeps until the next interrupt
+	sched_idle();
+	CHECK_EQ(mock_sleeps[idle], 1);
+	CHECK(SREG & (1 << SREG_I));
+	//A posted task keeps it awake
+	sched_post(&b);
+	sched_idle();
+	CHECK_EQ(mock_sleeps[idle], 1);
+	CHECK(SREG & (1 << SREG_I));
+	sched_run();
+	//So does a task that is due
+	sched_start(&c, 0, 0);
+	sched_idle();
+	CHECK_EQ(mock_sleeps[idle], 1);
+	sched_run();
+}
+
+static void test_report_output() {
+	sched_reset_stats();
+	sched_post(&b);
+	sched_run();
+	mock_uart_take();
+	sched_report();
+	//No counter given to sched_init, every run takes 0 cycles
+	CHECK_STR(mock_uart_take(), "c: n=0\r\nb: n=1 avg=0us max=0us\r\na: n=0\r\nidle: 0%\r\n");
+}
+
+int main() {
+	mock_reset();
+	sched_init(0, 1, 1);
+	sched_add(&a);
+	sched_add(&b);
+	sched_add(&c);
+	test_timed();
+	test_one_shot();
+	test_posted();
+	test_idle();
+	test_report_output();
+	return (test_report("sched"));
+}
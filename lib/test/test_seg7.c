@@ -0,0 +1,79 @@
+#include "fake_i2c.h"
+#include "mock.h"
+#include "pca9555.h"
+#include "seg7.h"
+#include "test.h"
+
+#define SEG7_2 0b01011011
+#define SEG7_4 0b01100110
+
+static void test_render() {
+	seg7_render_dec(42, 0);
+	CHECK_EQ(seg7_frame[0], 0);
+	CHECK_EQ(seg7_frame[1], 0);
+	CHECK_EQ(seg7_frame[2], SEG7_4);
+	CHECK_EQ(seg7_frame[3], SEG7_2);
+	seg7_render_dec(42, 1);
+	CHECK_EQ(seg7_frame[0], seg7_digit(0));
+	CHECK_EQ(seg7_frame[1], seg7_digit(0));
+	CHECK_EQ(seg7_frame[2], SEG7_4);
+	seg7_render_dec(0, 0);
+	CHECK_EQ(seg7_frame[2], 0);
+	CHECK_EQ(seg7_frame[3], seg7_digit(0));
+	//Last four digits only
+	seg7_render_dec(12345, 0);
+	CHECK_EQ(seg7_frame[0], seg7_digit(2));
+	CHECK_EQ(seg7_frame[3], seg7_digit(5));
+	//Every value against its digits
+	int failures = 0;
+	for (uint16_t n = 0; n < 10000; n++) {
+		seg7_render_dec(n, 1);
+		if (seg7_frame[0] != seg7_digit(n / 1000) || seg7_frame[1] != seg7_digit(n / 100 % 10)
+			|| seg7_frame[2] != seg7_digit(n / 10 % 10) || seg7_frame[3] != seg7_digit(n % 10))
+			failures++;
+	}
+	CHECK_EQ(failures, 0);
+	CHECK_EQ(seg7_digit(13), seg7_digit(3));
+	CHECK_EQ(seg7_char('-'), 0b01000000);
+	CHECK_EQ(seg7_char('x'), 0);
+}
+
+static void test_show() {
+	uint16_t writes = fake_expander.writes;
+	//Digit 2 on, LED IO0_0 on
+	seg7_show(0xFF & ~(1 << 6) & ~1, SEG7_4);
+	CHECK_EQ(fake_expander.writes - writes, 1);
+	CHECK_EQ(fake_expander.regs[2], 0xBE);
+	CHECK_EQ(fake_expander.regs[3], SEG7_4);
+}
+
+static void test_refresh() {
+	seg7_render_dec(1234, 0);
+	CHECK(seg7_refresh_async(0xFF));
+	//Still queued: nothing shown, the position stays
+	CHECK(!seg7_refresh_async(0xFF));
+	CHECK(!seg7_show_async(0xFF, 0));
+	fake_i2c_run();
+	CHECK_EQ(fake_expander.regs[2], 0xEF);
+	CHECK_EQ(fake_expander.regs[3], seg7_digit(1));
+	for (uint8_t position = 1; position < 5; position++) {
+		CHECK(seg7_refresh_async(0xFF));
+		fake_i2c_run();
+		CHECK_EQ(fake_expander.regs[2], 0xFF & ~(1 << (4 + (position & 3))));
+		CHECK_EQ(fake_expander.regs[3], seg7_digit(1 + (position & 3)));
+	}
+	//Shadow kept in step: writing the same outputs sends nothing
+	uint16_t writes = fake_expander.writes;
+	pca9555_write(PCA9555_OUTPUT, fake_expander.regs[2], fake_expander.regs[3]);
+	CHECK_EQ(fake_expander.writes, writes);
+}
+
+int main() {
+	mock_reset();
+	fake_i2c_reset();
+	test_render();
+	test_show();
+	test_refresh();
+	CHECK_EQ(fake_i2c_nacks, 0);
+	return (test_report("seg7"));
+}
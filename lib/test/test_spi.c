@@ -0,0 +1,110 @@
+#include <avr/io.h>
+#include "mock.h"
+#include "spi.h"
+#include "test.h"
+
+static uint16_t done_calls;
+
+static void done() {
+	done_calls++;
+}
+
+static void test_clock() {
+	static const struct {
+		uint8_t div;
+		uint8_t spr;
+		_Bool double_speed;
+	} clocks[] = {
+		{2, 0, 1},
+		{4, 0, 0},
+		{8, 1, 1},
+		{16, 1, 0},
+		{32, 2, 1},
+		{64, 2, 0},
+		{128, 3, 0}
+	};
+	mock_reset();
+	spi_master_init();
+	CHECK(SPCR & (1 << SPE));
+	CHECK(SPCR & (1 << MSTR));
+	CHECK_EQ(spi_get_clock(), SPI_DIVIDER);
+	for (uint8_t i = 0; i < sizeof clocks / sizeof *clocks; i++) {
+		spi_set_clock(clocks[i].div);
+		CHECK_EQ(spi_get_clock(), clocks[i].div);
+		CHECK_EQ(SPCR & ((1 << SPR1) | (1 << SPR0)), clocks[i].spr << SPR0);
+		CHECK_EQ(!!(SPSR & (1 << SPI2X)), clocks[i].double_speed);
+		//The other bits are kept
+		CHECK(SPCR & (1 << SPE));
+	}
+	//Not a power of 2 in range: slowest clock
+	spi_set_clock(3);
+	CHECK_EQ(spi_get_clock(), 128);
+	CHECK_EQ(SPCR & ((1 << SPR1) | (1 << SPR0)), (1 << SPR1) | (1 << SPR0));
+	CHECK(!(SPSR & (1 << SPI2X)));
+}
+
+static const uint8_t data[5] = {1, 2, 3, 4, 5};
+
+static void test_polled() {
+	mock_reset();
+	spi_master_init();
+	SREG |= (1 << SREG_I);
+	done_calls = 0;
+	for (uint8_t div = 2; div <= SPI_POLL_DIVIDER; div <<= 1) {
+		mock_spi_len = 0;
+		spi_set_clock(div);
+		//Sent before it returns, without the interrupt
+		CHECK(spi_send_async(data, sizeof data, done));
+		CHECK_EQ(mock_spi_len, sizeof data);
+		CHECK(!memcmp(mock_spi_out, data, sizeof data));
+		CHECK(!(SPCR & (1 << SPIE)));
+		CHECK(!spi_async_busy());
+	}
+	CHECK_EQ(done_calls, 2);
+	//Interrupts off (ISR or ATOMIC_BLOCK): sent by the interrupt once they are on
+	SREG &= ~(1 << SREG_I);
+	mock_spi_len = 0;
+	CHECK(spi_send_async(data, sizeof data, done));
+	CHECK(SPCR & (1 << SPIE));
+	CHECK(mock_spi_len < sizeof data);
+	CHECK(!spi_send_async(data, sizeof data, done));
+	SREG |= (1 << SREG_I);
+	mock_spi_drain();
+	CHECK_EQ(mock_spi_len, sizeof data);
+	CHECK(!memcmp(mock_spi_out, data, sizeof data));
+	CHECK_EQ(done_calls, 3);
+	CHECK(!spi_async_busy());
+}
+
+static void test_interrupt() {
+	mock_reset();
+	spi_master_init();
+	SREG |= (1 << SREG_I);
+	done_calls = 0;
+	spi_set_clock(SPI_POLL_DIVIDER * 2);
+	CHECK(!spi_send_async(data, 0, done));
+	CHECK(spi_send_async(data, sizeof data, done));
+	CHECK(SPCR & (1 << SPIE));
+	CHECK(spi_async_busy());
+	//One frame at a time
+	CHECK(!spi_send_async(data, sizeof data, done));
+	mock_spi_drain();
+	CHECK_EQ(mock_spi_len, sizeof data);
+	CHECK(!memcmp(mock_spi_out, data, sizeof data));
+	CHECK_EQ(done_calls, 1);
+	CHECK(!spi_async_busy());
+	//Interrupts off: the flush sends it by hand
+	mock_spi_len = 0;
+	CHECK(spi_send_async(data, sizeof data, done));
+	SREG &= ~(1 << SREG_I);
+	spi_async_flush();
+	CHECK_EQ(mock_spi_len, sizeof data);
+	CHECK_EQ(done_calls, 2);
+}
+
+int main() {
+	test_clock();
+	test_polled();
+	test_interrupt();
+	return (test_report("spi"));
+}
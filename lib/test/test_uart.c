@@ -0,0 +1,194 @@
+#include <string.h>
+#include <avr/io.h>
+#include "mock.h"
+#include "test.h"
+#include "uart.h"
+
+static void setup(void) {
+	mock_reset();
+	uart_init();
+	uart_set_overflow(uart_block);
+}
+
+static void test_queued() {
+	setup();
+	SREG |= (1 << SREG_I);
+	mock_uart_busy = 1;
+	uart_printstr("abc");
+	CHECK_EQ(mock_uart_len, 0);
+	CHECK(UCSR0B & (1 << UDRIE0));
+	CHECK(!uart_tx_idle());
+	mock_uart_busy = 0;
+	mock_uart_drain();
+	CHECK_STR(mock_uart_take(), "abc");
+	CHECK(!(UCSR0B & (1 << UDRIE0)));
+	CHECK(uart_tx_idle());
+}
+
+static void test_on_the_wire() {
+	setup();
+	SREG |= (1 << SREG_I);
+	//Buffer empty and data register free: written directly
+	uart_tx('x');
+	CHECK(!(UCSR0B & (1 << UDRIE0)));
+	//Still shifting out
+	mock_uart_busy = 1;
+	CHECK(!uart_tx_idle());
+	mock_uart_busy = 0;
+	CHECK(uart_tx_idle());
+	CHECK_STR(mock_uart_take(), "x");
+}
+
+static void fill(char *buf, uint8_t len) {
+	for (uint8_t i = 0; i < len; i++)
+		buf[i] = 'A' + i % 26;
+}
+
+static void test_interrupts_off() {
+	setup();
+	//As in an ISR: the first character goes straight to the data register,
+	//the others are queued for the UDRE interrupt
+	mock_uart_busy = 1;
+	uart_printstr("hi");
+	CHECK_EQ(mock_uart_len, 0);
+	CHECK(UCSR0B & (1 << UDRIE0));
+	mock_uart_busy = 0;
+	mock_uart_drain();
+	CHECK_STR(mock_uart_take(), "hi");
+	CHECK(!(UCSR0B & (1 << UDRIE0)));
+	CHECK(uart_tx_idle());
+}
+
+static void test_full_interrupts_off() {
+	char buf[UART_TX_BUFFER_SIZE + 6];
+	setup();
+	fill(buf, sizeof buf);
+	mock_uart_busy = 1;
+	uart_write(buf, UART_TX_BUFFER_SIZE - 1);
+	CHECK_EQ(mock_uart_len, 0);
+	//Full: uart_block sends the oldest characters by hand to make room
+	mock_uart_busy = 0;
+	uart_write(buf + UART_TX_BUFFER_SIZE - 1, 7);
+	//The last one leaves the data register at the next access
+	(void) UCSR0A;
+	CHECK_EQ(mock_uart_len, 7);
+	mock_uart_drain();
+	CHECK_EQ(mock_uart_len, sizeof buf);
+	CHECK(!memcmp(mock_uart_take(), buf, sizeof buf));
+}
+
+static void test_drop() {
+	char buf[UART_TX_BUFFER_SIZE + 6];
+	setup();
+	fill(buf, sizeof buf);
+	SREG |= (1 << SREG_I);
+	uart_set_overflow(uart_drop);
+	uint16_t overflows = uart_get_overflows();
+	mock_uart_busy = 1;
+	//One slot of the ring stays free
+	CHECK_EQ(uart_write(buf, sizeof buf), UART_TX_BUFFER_SIZE - 1);
+	CHECK_EQ(uart_get_overflows() - overflows, 1);
+	mock_uart_busy = 0;
+	mock_uart_drain();
+	CHECK_EQ(mock_uart_len, UART_TX_BUFFER_SIZE - 1);
+	CHECK(!memcmp(mock_uart_take(), buf, UART_TX_BUFFER_SIZE - 1));
+}
+
+static void test_overwrite() {
+	char buf[UART_TX_BUFFER_SIZE + 6];
+	setup();
+	fill(buf, sizeof buf);
+	SREG |= (1 << SREG_I);
+	uart_set_overflow(uart_overwrite);
+	uint16_t overflows = uart_get_overflows();
+	mock_uart_busy = 1;
+	CHECK_EQ(uart_write(buf, sizeof buf), sizeof buf);
+	CHECK_EQ(uart_get_overflows() - overflows, 7);
+	mock_uart_busy = 0;
+	mock_uart_drain();
+	//The newest characters are kept
+	CHECK_EQ(mock_uart_len, UART_TX_BUFFER_SIZE - 1);
+	CHECK(!memcmp(mock_uart_take(), buf + 7, UART_TX_BUFFER_SIZE - 1));
+}
+
+static void test_order_interrupts_off() {
+	setup();
+	SREG |= (1 << SREG_I);
+	mock_uart_busy = 1;
+	uart_printstr("ab");
+	mock_uart_busy = 0;
+	//From an ISR: queued behind what is waiting
+	SREG &= ~(1 << SREG_I);
+	uart_tx('c');
+	CHECK_EQ(mock_uart_len, 0);
+	mock_uart_drain();
+	CHECK_STR(mock_uart_take(), "abc");
+	CHECK(!(UCSR0B & (1 << UDRIE0)));
+}
+
+static void test_print() {
+	setup();
+	uart_print_dec(1234);
+	uart_print_hex(0x4F);
+	uart_print_bin(5);
+	uart_print_nl("");
+	mock_uart_drain();
+	CHECK_STR(mock_uart_take(), "12344F0b00000101\r\n");
+}
+
+static void receive(const char *str) {
+	while (*str)
+		mock_uart_receive(*str++);
+}
+
+static void test_rx() {
+	char buf[8];
+	uart_line line;
+	setup();
+	uart_rx_init();
+	CHECK(SREG & (1 << SREG_I));
+	uart_line_init(&line, buf, sizeof buf, uart_echo_on);
+	receive("hk");
+	CHECK_EQ(uart_rx_available(), 2);
+	CHECK_EQ(uart_line_poll(&line), uart_line_pending);
+	//Backspace, then a control character that is ignored
+	receive("\x7fi\x01\r");
+	CHECK_EQ(uart_line_poll(&line), uart_line_ready);
+	CHECK_STR(buf, "hi");
+	CHECK_STR(mock_uart_take(), "hk\b \bi\r\n");
+	uart_line_init(&line, buf, sizeof buf, uart_echo_masked);
+	receive("secret!!\r");
+	CHECK_EQ(uart_line_poll(&line), uart_line_too_long);
+	CHECK_STR(mock_uart_take(), "*******\r\n");
+	//What follows the too long line starts a new one
+	CHECK_EQ(uart_line_poll(&line), uart_line_ready);
+	CHECK_STR(buf, "");
+	mock_uart_take();
+}
+
+static void test_rx_overflow() {
+	setup();
+	uart_rx_init();
+	uint16_t overflows = uart_rx_get_overflows();
+	for (uint8_t i = 0; i < UART_RX_BUFFER_SIZE; i++)
+		mock_uart_receive('a' + i % 26);
+	CHECK_EQ(uart_rx_available(), UART_RX_BUFFER_SIZE - 1);
+	CHECK_EQ(uart_rx_get_overflows() - overflows, 1);
+	CHECK_EQ(uart_rx(), 'a');
+	while (uart_rx_available())
+		uart_rx();
+}
+
+int main() {
+	test_interrupts_off();
+	test_full_interrupts_off();
+	test_queued();
+	test_on_the_wire();
+	test_drop();
+	test_overwrite();
+	test_order_interrupts_off();
+	test_print();
+	test_rx();
+	test_rx_overflow();
+	return (test_report("uart"));
+}
@@ -0,0 +1,174 @@
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <util/atomic.h>
+#include "fmt.h"
+#include "uart.h"
+
+#define UART_TX_MASK (UART_TX_BUFFER_SIZE - 1)
+
+#if (UART_TX_BUFFER_SIZE & UART_TX_MASK) || UART_TX_BUFFER_SIZE > 256
+# error "UART_TX_BUFFER_SIZE must be a power of 2 no larger than 256"
+#endif
+
+//Characters are queued at head by uart_tx and sent from tail by the UDRE interrupt
+static volatile char tx_buffer[UART_TX_BUFFER_SIZE];
+static volatile uint8_t tx_head = 0;
+static volatile uint8_t tx_tail = 0;
+static enum uart_overflow_e tx_policy = uart_block;
+static volatile uint16_t tx_overflows = 0;
+//Set once a character was written, TXC0 stays clear until then
+static volatile _Bool tx_started = 0;
+
+void uart_init() {
+	//Enable transmitter and receiver on USART0
+	UCSR0B |= (1 << TXEN0) | (1 << RXEN0);
+	//Keep defaults : async with no parity and 1 stop bit
+	//Set character size to 8 bits
+	UCSR0C |= (1 << UCSZ00) | (1 << UCSZ01);
+	//Set baud rate to UART_BAUDRATE
+	UBRR0 = (F_CPU / 8 / UART_BAUDRATE - 1) / 2;
+}
+
+void uart_set_overflow(enum uart_overflow_e policy) {
+	tx_policy = policy;
+}
+
+uint16_t uart_get_overflows() {
+	uint16_t n;
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		n = tx_overflows;
+	}
+	return (n);
+}
+
+static void tx_write(char c) {
+	//Clear transmit complete, it is set again once c has been shifted out
+	UCSR0A |= (1 << TXC0);
+	UDR0 = c;
+	tx_started = 1;
+}
+
+static void tx_send_next() {
+	//Move the oldest queued character to the data register
+	tx_write(tx_buffer[tx_tail]);
+	tx_tail = (tx_tail + 1) & UART_TX_MASK;
+	//Nothing left to send, stop the data register empty interrupt
+	if (tx_tail == tx_head)
+		UCSR0B &= ~(1 << UDRIE0);
+}
+
+ISR(USART_UDRE_vect) {
+	tx_send_next();
+}
+
+//Returns 0 if the character had to be dropped
+static uint8_t tx_make_room() {
+	uint8_t next = (tx_head + 1) & UART_TX_MASK;
+	while (next == tx_tail) {
+		switch (tx_policy) {
+		case uart_drop:
+			tx_overflows++;
+			return (0);
+		case uart_overwrite:
+			ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+				//The interrupt may have freed a slot since we checked
+				if (next == tx_tail) {
+					tx_tail = (tx_tail + 1) & UART_TX_MASK;
+					tx_overflows++;
+				}
+			}
+			break;
+		case uart_block:
+			//With interrupts off (in an ISR or before sei) the UDRE interrupt
+			//can't free a slot, send the oldest character ourselves
+			if (!(SREG & (1 << SREG_I)) && (UCSR0A & (1 << UDRE0)))
+				tx_send_next();
+			break;
+		}
+	}
+	return (1);
+}
+
+//Queues c, also from an ISR: the UDRE interrupt sends it once interrupts are
+//back on. Only waits (uart_block) when the buffer is full
+void uart_tx(char c) {
+	do {
+		ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+			//Skip the buffer when it is empty and the USART can take the character now
+			if (tx_head == tx_tail && (UCSR0A & (1 << UDRE0))) {
+				tx_write(c);
+				return;
+			}
+			//Reserve the slot and fill it before an ISR can queue behind it
+			uint8_t next = (tx_head + 1) & UART_TX_MASK;
+			if (next != tx_tail) {
+				tx_buffer[tx_head] = c;
+				tx_head = next;
+				//Let the UDRE interrupt send it
+				UCSR0B |= (1 << UDRIE0);
+				return;
+			}
+		}
+	} while (tx_make_room());
+}
+
+uint8_t uart_write(const char *buf, uint8_t len) {
+	uint8_t sent = 0;
+	uint16_t overflows = tx_overflows;
+	for (uint8_t i = 0; i < len; i++) {
+		uart_tx(buf[i]);
+		//With the drop policy stop at the first character that didn't fit
+		if (tx_policy == uart_drop && tx_overflows != overflows)
+			break;
+		sent++;
+	}
+	return (sent);
+}
+
+void uart_printstr(const char *str) {
+	for (int i = 0; str[i]; i++) {
+		uart_tx(str[i]);
+	}
+}
+
+void uart_flush() {
+	while (tx_head != tx_tail) {
+		if (!(SREG & (1 << SREG_I)) && (UCSR0A & (1 << UDRE0)))
+			tx_send_next();
+	}
+	//Wait for the last character to be moved to the shift register
+	while (!(UCSR0A & (1 << UDRE0))) {}
+}
+
+//1 once every character has been shifted out (the I/O clock can be stopped)
+uint8_t uart_tx_idle() {
+	uint8_t idle;
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		idle = tx_head == tx_tail && (!tx_started || (UCSR0A & (1 << TXC0)));
+	}
+	return (idle);
+}
+
+void uart_print_nl(const char *str) {
+	uart_printstr(str);
+	uart_printstr("\r\n");
+}
+
+void uart_print_hex(uint8_t n) {
+	char output[3];
+	fmt_hex(output, n, 2);
+	uart_printstr(output);
+}
+
+void uart_print_dec(uint16_t n) {
+	char output[FMT_DEC_SIZE];
+	fmt_dec(output, n, 0, ' ');
+	uart_printstr(output);
+}
+
+void uart_print_bin(uint8_t n) {
+	char output[9];
+	fmt_bin(output, n);
+	uart_printstr("0b");
+	uart_printstr(output);
+}
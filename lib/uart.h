@@ -0,0 +1,71 @@
+#ifndef UART_H
+#define UART_H
+
+#include <stdint.h>
+
+//Size of the transmit ring buffer, must be a power of 2 no larger than 256
+#ifndef UART_TX_BUFFER_SIZE
+# define UART_TX_BUFFER_SIZE 64
+#endif
+
+//Size of the receive ring buffer, must be a power of 2 no larger than 256
+#ifndef UART_RX_BUFFER_SIZE
+# define UART_RX_BUFFER_SIZE 32
+#endif
+
+//What uart_tx does when the transmit buffer is full
+//Characters are queued from ISRs too and sent by the UDRE interrupt, so
+//interrupts must be enabled for the buffer to drain. With interrupts off
+//uart_block sends the oldest queued character by hand to make room
+enum uart_overflow_e {
+	//Discard the new character
+	uart_drop,
+	//Wait for room
+	uart_block,
+	//Discard the oldest queued character
+	uart_overwrite
+};
+
+void uart_init();
+void uart_set_overflow(enum uart_overflow_e policy);
+uint16_t uart_get_overflows();
+void uart_tx(char c);
+uint8_t uart_write(const char *buf, uint8_t len);
+void uart_printstr(const char *str);
+void uart_flush();
+uint8_t uart_tx_idle();
+void uart_print_nl(const char *str);
+void uart_print_hex(uint8_t n);
+void uart_print_dec(uint16_t n);
+void uart_print_bin(uint8_t n);
+void uart_bench();
+
+//How uart_line_poll echoes what is typed
+enum uart_echo_e {
+	uart_echo_off,
+	uart_echo_on,
+	//Echo '*' instead of the character (passwords)
+	uart_echo_masked
+};
+
+enum uart_line_status_e {
+	uart_line_pending,
+	uart_line_ready,
+	uart_line_too_long
+};
+
+typedef struct uart_line_s {
+	char *buf;
+	uint8_t size;
+	uint8_t len;
+	enum uart_echo_e echo;
+} uart_line;
+
+void uart_rx_init();
+uint8_t uart_rx_available();
+uint16_t uart_rx_get_overflows();
+char uart_rx();
+void uart_line_init(uart_line *line, char *buf, uint8_t size, enum uart_echo_e echo);
+enum uart_line_status_e uart_line_poll(uart_line *line);
+
+#endif
@@ -0,0 +1,103 @@
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <util/atomic.h>
+#include "uart.h"
+
+#define UART_RX_MASK (UART_RX_BUFFER_SIZE - 1)
+
+#if (UART_RX_BUFFER_SIZE & UART_RX_MASK) || UART_RX_BUFFER_SIZE > 256
+# error "UART_RX_BUFFER_SIZE must be a power of 2 no larger than 256"
+#endif
+
+//Characters are queued at head by the RX interrupt and read from tail by uart_rx
+static volatile char rx_buffer[UART_RX_BUFFER_SIZE];
+static volatile uint8_t rx_head = 0;
+static volatile uint8_t rx_tail = 0;
+static volatile uint16_t rx_overflows = 0;
+
+void uart_rx_init() {
+	//Enable interrupt on USART0 receive
+	SREG |= (1 << SREG_I);
+	UCSR0B |= (1 << RXCIE0);
+}
+
+ISR(USART_RX_vect) {
+	//Read flags before the data register, reading UDR0 clears them
+	uint8_t status = UCSR0A;
+	char c = UDR0;
+	uint8_t next = (rx_head + 1) & UART_RX_MASK;
+	if (next == rx_tail || (status & ((1 << FE0) | (1 << DOR0)))) {
+		rx_overflows++;
+		return;
+	}
+	rx_buffer[rx_head] = c;
+	rx_head = next;
+}
+
+uint8_t uart_rx_available() {
+	return ((rx_head - rx_tail) & UART_RX_MASK);
+}
+
+uint16_t uart_rx_get_overflows() {
+	uint16_t n;
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		n = rx_overflows;
+	}
+	return (n);
+}
+
+char uart_rx() {
+	//Wait for the RX interrupt to have received something
+	while (rx_head == rx_tail) {}
+	char c = rx_buffer[rx_tail];
+	rx_tail = (rx_tail + 1) & UART_RX_MASK;
+	return (c);
+}
+
+void uart_line_init(uart_line *line, char *buf, uint8_t size, enum uart_echo_e echo) {
+	line->buf = buf;
+	line->size = size;
+	line->len = 0;
+	line->echo = echo;
+}
+
+//Consumes whatever has been received so far without waiting for more
+//buf holds a null terminated line when uart_line_ready is returned
+enum uart_line_status_e uart_line_poll(uart_line *line) {
+	while (uart_rx_available()) {
+		char c = uart_rx();
+		if (c == 127) {
+			//Backspace
+			if (line->len != 0) {
+				line->len--;
+				if (line->echo != uart_echo_off)
+					uart_printstr("\b \b");
+			}
+			continue;
+		}
+		if (c == '\r') {
+			line->buf[line->len] = 0;
+			line->len = 0;
+			if (line->echo != uart_echo_off)
+				uart_printstr("\r\n");
+			return (uart_line_ready);
+		}
+		//Ignore other control characters
+		if (c < ' ' || c > 126)
+			continue;
+		//Keep room for the terminating null byte
+		if (line->len == line->size - 1) {
+			line->len = 0;
+			if (line->echo != uart_echo_off)
+				uart_printstr("\r\n");
+			return (uart_line_too_long);
+		}
+		line->buf[line->len] = c;
+		line->len++;
+		if (line->echo == uart_echo_on)
+			uart_tx(c);
+		else if (line->echo == uart_echo_masked)
+			uart_tx('*');
+	}
+	return (uart_line_pending);
+}
@@ -10,6 +10,9 @@
 // 	void vector (void) __attribute__ ((signal,__INTR_ATTRS)) __VA_ARGS__; \
 // 	void vector (void)
 #include <avr/interrupt.h>
+#include "button.h"
+#include "led.h"
+#include "uart.h"
 
 enum g_stat {
 	lobby,
@@ -26,37 +29,9 @@ volatile int nb_players = 3;
 volatile int nb_ready = 0;
 volatile enum g_stat game_status = lobby;
 volatile _Bool twi_busy = 0;
-_Bool sw1_pressed = 0;
-_Bool sw2_pressed = 0;
-
-void uart_init() {
-	//Enable transmitter on USART0
-	UCSR0B |= (1 << TXEN0);
-	//Keep defaults : async with no parity and 1 stop bit
-	//Set character size to 8 bits
-	UCSR0C |= (1 << UCSZ00) | (1 << UCSZ00);
-	//Set baud rate to UART_BAUDRATE
-	UBRR0 = (F_CPU / 8 / UART_BAUDRATE - 1) / 2;
-}
-
-void uart_tx(char c) {
-	//Wait for USART to be ready to transmit
-	while (!(UCSR0A & (1 << UDRE0))) {}
-	//Transmit character
-	UDR0 = c;
-}
-
-void uart_printstr(const char *str) {
-	for (int i = 0; str[i]; i++) {
-		uart_tx(str[i]);
-	}
-}
-
-void uart_print_nl(const char *str) {
-	uart_printstr(str);
-	uart_printstr("\r\n");
-}
 
+//The TWI runs as an interrupt driven multi-master slave here
+//so this keeps its own driver instead of the one in lib
 void i2c_init() {
 	//Enable TWI module and acknowledgement
 	TWCR |= (1 << TWEN) | (1 << TWEA);
@@ -112,28 +87,17 @@ void io_init() {
 	set_rgb('R');
 }
 
-void display(int n) {
-	//Switch all LEDs off
-	PORTB &= ~((1 << PB0) | (1 << PB1) | (1 << PB2) | (1 << PB4));
-	//Deal with third LED not being PORTB3
-	if (n & 0b1000) {
-		PORTB |= (1 << PB4);
-	}
-	//Display the nice bits
-	PORTB |= n & 0b111;
-}
-
 void io_countdown(void) {
 	set_rgb('B');
 	int n = 15;
 	int i = 8;
 	while (i > 0 && game_status == countdown) {
-		display(n);
+		display_n_led(n);
 		_delay_ms(500);
 		n -= i;
 		i /= 2;
 	}
-	display(n);
+	display_n_led(n);
 	if (game_status != countdown)
 		return;
 	_delay_ms(500);
@@ -149,7 +113,7 @@ void io_win(void) {
 	uart_print_nl("Bravoooo !");
 	for (int i = 0; i < 20; i++)
 	{
-		display(n);
+		display_n_led(n);
 		if (direction)
 			n *= 2;
 		else
@@ -186,19 +150,6 @@ void io_error(void) {
 	}
 }
 
-void interrupt_init() {
-	//Enable interrupts globally
-	SREG |= (1 << SREG_I);
-	//Enable interrupts on SW1 (INT0)
-	EIMSK |= (1 << INT0);
-	EICRA |= (1 << ISC00);
-	//Enable interrupts on SW2 (PCINT20)
-	PCICR |= (1 << PCIE2);
-	PCMSK2 |= (1 << PCINT20);
-	//Enable interrupts on TWI
-	TWCR |= (1 << TWIE);
-}
-
 void print_twi_status() {
 	char *base = "0123456789ABCDEF";
 	int status = TW_STATUS;
@@ -532,6 +483,29 @@ void i2c_end() {
 	}
 }
 
+void handle_button(button_event event) {
+	if (event.type != button_press)
+		return;
+	if (event.button == button_sw1) {
+		if ((game_status == lobby || game_status == countdown || game_status == playing) && !twi_busy)
+			i2c_start();
+	} else if (event.button == button_sw2) {
+		print_game_status();
+	}
+}
+
+void interrupt_init() {
+	//Enable interrupts globally
+	SREG |= (1 << SREG_I);
+	//Sample SW1 and SW2 every 1ms on timer 2, presses are handled right
+	//away from the timer interrupt so the reaction time is not delayed by
+	//the animations of the main loop
+	button_init(0, handle_button);
+	button_timer_init();
+	//Enable interrupts on TWI
+	TWCR |= (1 << TWIE);
+}
+
 ISR(TWI_vect) {
 	switch (game_status) {
 	case lobby:
@@ -555,25 +529,6 @@ ISR(TWI_vect) {
 	}
 }
 
-ISR(INT0_vect) {
-	sw1_pressed = !sw1_pressed;
-	if (sw1_pressed) {
-		if ((game_status == lobby || game_status == countdown || game_status == playing) && !twi_busy)
-			i2c_start();
-	}
-	_delay_ms(20);
-	EIFR |= (1 << INTF0);
-}
-
-ISR(PCINT2_vect) {	
-	sw2_pressed = !sw2_pressed;
-	if (sw2_pressed) {
-		print_game_status();
-	}
-	_delay_ms(20);
-	PCIFR |= (1 << PCIF2);
-}
-
 int main() {
 	uart_init();
 	i2c_init();
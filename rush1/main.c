@@ -2,12 +2,37 @@
 #include <util/delay.h>
 #include <avr/interrupt.h>
 #include <util/twi.h>
+#include <util/atomic.h>
+//Timer 1 runs the RGB effects, the profiler samples timer 0 instead
+#define PROF_TIMER0
+#include "adc.h"
+#include "aht20.h"
+#include "apa102.h"
+#include "button.h"
+#include "colour.h"
+#include "fmt.h"
+#include "i2c.h"
+#include "led.h"
+#include "pca9555.h"
+#include "prof.h"
+#include "sched.h"
+#include "seg7.h"
+#include "spi.h"
+#include "uart.h"
 
-#define TWI_BAUDRATE 100000ul
-#define IO_EXP_ADDR 0b01000000
-#define AHT_ADDR 0b01110000
 #define RTC_ADDR 0b10100010
 
+const i2c_profile i2c_profiles[] = {
+	I2C_PROFILE(PCA9555_ADDR, I2C_FAST_BAUDRATE),
+	I2C_PROFILE(AHT20_ADDR, I2C_FAST_BAUDRATE),
+	I2C_PROFILE(RTC_ADDR, I2C_FAST_BAUDRATE)
+};
+
+enum prof_slots {
+	prof_timer0_ovf,
+	prof_timer1_compa
+};
+
 enum mode_e {
 	potentiometer,
 	photoresistor,
@@ -38,191 +63,15 @@ volatile enum mode_e mode = start;
 volatile char display_str[5] = {'8', '8', '8', '8', '\0'};
 volatile uint8_t decimal_mask = 0b1111;
 uint8_t display_position = 0;
-volatile _Bool sw1_pressed = 0;
-volatile _Bool sw2_pressed = 0;
 volatile char colour = 'R';
 volatile uint8_t rgb_position = 0;
-uint8_t value_refresh_counter = 0;
 time_t time;
 
-//------------------------- UART utils -------------------------
-
-void uart_init() {
-	//Enable transmitter on USART0
-	UCSR0B |= (1 << TXEN0);
-	//Keep defaults : async with no parity and 1 stop bit
-	//Set character size to 8 bits
-	UCSR0C |= (1 << UCSZ00) | (1 << UCSZ00);
-	//Set baud rate to UART_BAUDRATE
-	UBRR0 = (F_CPU / 8 / UART_BAUDRATE - 1) / 2;
-}
-
-void uart_tx(char c) {
-	//Wait for USART to be ready to transmit
-	while (!(UCSR0A & (1 << UDRE0))) {}
-	//Transmit character
-	UDR0 = c;
-}
-
-void uart_printstr(const char *str) {
-	for (int i = 0; str[i]; i++) {
-		uart_tx(str[i]);
-	}
-}
-
-void uart_print_nl(const char *str) {
-	uart_printstr(str);
-	uart_printstr("\r\n");
-}
-
-void uart_print_hex(uint8_t n) {
-	char *base = "0123456789ABCDEF";
-	uart_tx(base[n / 16]);
-	uart_tx(base[n % 16]);
-}
-
-void uart_print_dec(uint16_t n) {
-	char output[6];
-	output[5] = 0;
-	int i = 4;
-	while (i >= 0) {
-		output[i] = n % 10 + '0';
-		n /= 10;
-		if (n == 0)
-			break;
-		i--;
-	}
-	uart_printstr(&output[i]);
-}
-
-void uart_print_bin(uint8_t n) {
-	uart_printstr("0b");
-	for (int i = 7; i >= 0; i--) {
-		uart_tx(((n >> i) & 1) + '0');
-	}
-}
-
-//------------------------- I2C utils -------------------------
-
-void i2c_init() {
-	//Set baudrate (with prescaler set to 1x)
-	TWBR = (uint8_t) (F_CPU / TWI_BAUDRATE / 2 - 8);
-	//Enable TWI module
-	TWCR |= (1 << TWEN);
-}
-
-int wait_i2c_ready() {
-	while ((TWCR & (1 << TWINT)) == 0) {}
-	return (TW_STATUS);
-}
-
-void i2c_start() {
-	//Set start bit and clear TWINT bit (notifies module to continue)
-	TWCR = (1 << TWSTA) | (1 << TWINT) | (1 << TWEN);
-}
-
-void i2c_stop() {
-	wait_i2c_ready();
-	//Set stop bit and TWINT bit
-	TWCR = (1 << TWSTO) | (1 << TWEN) | (1 << TWINT);
-}
-void i2c_write(uint8_t data) {
-	wait_i2c_ready();
-	TWDR = data;
-	//Clear interrupt
-	TWCR = (1 << TWINT) | (1 << TWEN);
-}
-
-uint8_t i2c_read() {
-	wait_i2c_ready();
-	return (TWDR);
-}
-
-void i2c_ack() {
-	TWCR = (1 << TWEA) | (1 << TWINT) | (1 << TWEN);
-}
-
-void i2c_nack() {
-	TWCR = (1 << TWINT) | (1 << TWEN);
-}
-
-//------------------------- ADC utils -------------------------
-
-void adc_init() {
-	//Set Vref to AVcc
-	ADMUX |= (1 << REFS0);
-	//Select RV1 (ADC0) (default
-	//ADC clock should be between 50kHz and 200kHz
-	//Set prescaler to 128 -> clock = 125kHz
-	ADCSRA |= (1 << ADPS2) | (1 << ADPS1)| (1 << ADPS0);
-	//Enable ADC
-	ADCSRA |= (1 << ADEN);
-}
-
-uint16_t adc_get_conv() {
-	ADCSRA |= (1 << ADSC);
-	while (ADCSRA & (1 << ADSC)) {}
-	return (ADC);
-}
-
 //------------------------- SPI utils -------------------------
 
-void spi_master_init() {
-	//Set SCK and MOSI and SS to outputs
-	DDRB |= (1 << DDB2) | (1 << DDB3) | (1 << DDB5);
-	//Set SPI to master
-	SPCR |= (1 << MSTR);
-	//Set clock divider to 16 -> 1Mhz (acceptable range for LEDs 0.8-1.2MHz)
-	SPCR |= (1 << SPR0);
-	//Enable SPI
-	SPCR |= (1 << SPE);
-}
-
-void spi_enable() {
-	SPCR |= (1 << SPE);
-}
-
-void spi_disable() {
-	SPCR &= ~(1 << SPE);
-}
-
-void spi_transmit(uint8_t data) {
-	SPDR = data;
-	//Wait for transmission to finish
-	while (!(SPSR & (1 << SPIF))) {}
-}
-
-void set_spi_rgb(uint8_t r, uint8_t g, uint8_t b) {
-	//Max is 31
-	uint8_t brightness = 1;
-	//Transmit four bytes of 0s
-	for (int i = 0; i < 4; i++) {
-		spi_transmit(0);
-	}
-	//Transmit four LED frames
-	for (int i = 0; i < 3; i++) {
-		spi_transmit(0b11100000 | brightness);
-		spi_transmit(b);
-		spi_transmit(g);
-		spi_transmit(r);
-	}
-	//Transmit four bytes of 1s
-	for (int i = 0; i < 4; i++) {
-		spi_transmit(255);
-	}
-}
-
 void wheel_spi(uint8_t pos) {
-	pos = 255 - pos;
-	if (pos < 85) {
-		set_spi_rgb(255 - pos * 3, 0, pos * 3);
-	} else if (pos < 170) {
-		pos = pos - 85;
-		set_spi_rgb(0, pos * 3, 255 - pos * 3);
-	} else {
-		pos = pos - 170;
-		set_spi_rgb(pos * 3, 255 - pos * 3, 0);
-	}
+	rgb_colour c = wheel(pos);
+	apa102_set_all(c.r, c.g, c.b);
 }
 
 //------------------------- GPIO -------------------------
@@ -231,54 +80,12 @@ void io_init() {
 	//Set GPIO LEDs to output
 	DDRB |= (1 << DDB0) | (1 << DDB1) | (1 << DDB2) | (1 << DDB4);
 	DDRD |= (1 << DDD3) | (1 << DDD5) | (1 << DDD6);
-	//Enable interrupts on change for SW1 and SW2
-	SREG |= (1 << SREG_I);
-	EICRA |= (1 << ISC00);
-	EIMSK |= (1 << INT0);
-	PCICR |= (1 << PCIE2);
-	PCMSK2 |= (1 << PCINT20);
-	i2c_start();
-	//Address io expander
-	i2c_write(IO_EXP_ADDR | TW_WRITE);
-	//Send configuration command
-	i2c_write(0x06);
-	//Set IO0_0 to input
-	i2c_write(1);
-	//Set IO1 to output
-	i2c_write(0);
-	i2c_stop();
-}
-
-void display_n_led(uint8_t n) {
-	//Switch all LEDs off
-	PORTB &= ~((1 << PB0) | (1 << PB1) | (1 << PB2) | (1 << PB4));
-	//Deal with third LED not being PORTB3
-	if (n & 0b1000) {
-		PORTB |= (1 << PB4);
-	}
-	//Display the nice bits
-	PORTB |= n & 0b111;
-}
-
-_Bool is_sw3_pressed() {
-	_Bool is_pressed;
-	i2c_start();
-	//Address io expander
-	i2c_write(IO_EXP_ADDR | TW_WRITE);
-	//Send input0 command
-	i2c_write(0);
-	wait_i2c_ready();
-	i2c_start();
-	i2c_write(IO_EXP_ADDR | TW_READ);
-	wait_i2c_ready();
-	i2c_ack();
-	uint8_t input0 = i2c_read();
-	is_pressed = !(input0 & 1);
-	i2c_nack();
-	i2c_read();
-	//Set stop bit
-	TWCR |= (1 << TWSTO) | (1 << TWINT);
-	return (is_pressed);
+	//Set IO0_0 to input and IO1 to output
+	pca9555_write(PCA9555_CONFIG, 1, 0);
+	pca9555_input_init(0);
+	//Switches are sampled by the display interrupt, SW3 from the expander
+	//inputs it polls
+	button_init(pca9555_inputs, 0);
 }
 
 void set_all_rgb(char c) {
@@ -286,19 +93,19 @@ void set_all_rgb(char c) {
 	port_d_save &= ~((1 << PD3) | (1 << PD5) | (1 << PD6));
 	switch (c) {
 	case 'R':
-		set_spi_rgb(255, 0, 0);
+		apa102_set_all(255, 0, 0);
 		PORTD = port_d_save | (1 << PD5);
 		break;
 	case 'G':
-		set_spi_rgb(0, 255, 0);
+		apa102_set_all(0, 255, 0);
 		PORTD = port_d_save | (1 << PD6);
 		break;
 	case 'B':
-		set_spi_rgb(0, 0, 255);
+		apa102_set_all(0, 0, 255);
 		PORTD = port_d_save | (1 << PD3);
 		break;
 	default:
-		set_spi_rgb(0, 0, 0);
+		apa102_set_all(0, 0, 0);
 		PORTD = port_d_save;
 		break;
 	}
@@ -317,144 +124,70 @@ void timers_init() {
 	//Set to CTC mode with OCR1A as top and 1024x prescaler
 	//Interrupts will be off for now
 	TCCR1B |= (1 << WGM12) | (1 << CS10) | (1 << CS12);
-	//Timer 2 triggers the update of the display value
-	//Set timer to normal mode with 1024x prescaler and no interrupts
-	//This will be used to generate interrupts at intervals of 16ms
-	TCCR2B |= (1 << CS20) | (1 << CS21) | (1 << CS22);
-}
-
-void start_value_update_timer() {
-	TIMSK2 |= (1 << TOIE2);
 }
 
 //------------------------- Display utils -------------------------
 
-uint8_t get_segment_char(char c) {
-	switch (c) {
-	case '0':
-		return (0b00111111);
-	case '1':
-		return (0b00000110);
-	case '2':
-		return (0b01011011);
-	case '3':
-		return (0b01001111);
-	case '4':
-		return (0b01100110);
-	case '5':
-		return (0b01101101);
-	case '6':
-		return (0b01111101);
-	case '7':
-		return (0b00000111);
-	case '8':
-		return (0b01111111);
-	case '9':
-		return (0b01101111);
-	case '-':
-		return (0b01000000);
-	case 'C':
-		return (0b00111001);
-	case 'F':
-		return (0b01110001);
-	case 'H':
-		return (0b01110110);
-	}
-	return(0);
-}
-
 void uint_display(uint16_t n) {
-	for (int i = 3; i >= 0; i--) {
-		display_str[i] = n % 10 + '0';
-		n /= 10;
+	char digits[FMT_DEC_SIZE];
+	uint8_t len = fmt_dec(digits, n, 4, '0');
+	//Keep the last 4 digits
+	for (int i = 0; i < 4; i++) {
+		display_str[i] = digits[len - 4 + i];
 	}
 }
 
-void float_display(float f) {
+//Shows a value in hundredths with one decimal (the decimal point is set by
+//decimal_mask), e.g. 2345 as " 23.4". The first character is left blank when
+//possible so the caller can put the unit there
+void centi_display(int16_t n) {
 	_Bool is_negative = 0;
-	if (f < 0) {
+	if (n < 0) {
 		is_negative = 1;
-		f = -f;
+		n = -n;
 	}
-	if ((int) (f / 100))
-		display_str[0] = (int) (f / 100) % 10 + '0';
+	//Hundreds, tens, units, tenths and hundredths, the last one is dropped
+	char digits[FMT_DEC_SIZE];
+	fmt_dec(digits, n, 5, '0');
+	if (digits[0] != '0')
+		display_str[0] = digits[0];
 	else
 		display_str[0] = ' ';
-	if ((int) (f / 10))
-		display_str[1] = (int) (f / 10) % 10 + '0';
+	if (digits[0] != '0' || digits[1] != '0')
+		display_str[1] = digits[1];
 	else
-		display_str[0] = ' ';
-	display_str[2] = (int) f % 10 + '0';
-	display_str[3] = (int) (f * 10) % 10 + '0';
+		display_str[1] = ' ';
+	display_str[2] = digits[2];
+	display_str[3] = digits[3];
 	if (is_negative)
 		display_str[0] = '-';
 }
 
 //------------------------- AHT utils -------------------------
 
-void aht_request_measurement() {
-	//Send measurement command
-	i2c_start();
-	i2c_write(AHT_ADDR | TW_WRITE);
-	i2c_write(0xAC);
-	i2c_write(0x33);
-	i2c_write(0);
-	i2c_stop();
-	//Generate interrupt in 80ms when measurement is ready
-	OCR1A = 1250;
-	TIFR1 |= (1 << OCF1A);
-	TIMSK1 |= (1 << OCIE1A);
-	TCNT1 = 0;
-}
-
-uint64_t aht_get_value() {
-	//Disable interrupts on timer1
-	TIMSK1 &= ~(1 << OCIE1A);
-	uint64_t res = 0;
-	i2c_start();
-	i2c_write(AHT_ADDR | TW_READ);
-	wait_i2c_ready();
-	i2c_ack();
-	uint8_t status = i2c_read();
-	if ((status & (1 << 7))) {
-		uart_print_nl("AHT didn't wait long enough");
-		i2c_nack();
-		i2c_stop();
-		return (0);
-	}
-	if (!(status & (1 << 3)))
-		uart_print_nl("AHT not calibrated");
-	for (int i = 4; i >= 0; i--) {
-		if (i != 0)
-			i2c_ack();
-		else
-			i2c_nack();
-		uint8_t d = i2c_read();
-		res = res << 8;
-		res |= d;
+//Measurements come from the background sampler run by aht_task, every mode
+//shows the same cached reading
+void update_value_aht() {
+	aht20_reading reading;
+	if (!aht20_get(&reading))
+		return;
+	switch (mode) {
+	case temp_c:
+		centi_display(reading.temp_c);
+		if (display_str[0] == ' ')
+			display_str[0] = 'C';
+		break;
+	case temp_f:
+		centi_display(reading.temp_f);
+		if (display_str[0] == ' ')
+			display_str[0] = 'F';
+		break;
+	case humidity:
+		centi_display(reading.humidity);
+		if (display_str[0] == ' ')
+			display_str[0] = 'H';
+		break;
 	}
-	i2c_stop();
-	return (res);
-}
-
-float aht_get_temp_c() {
-	float res;
-	uint64_t data = aht_get_value();
-	data &= 0xFFFFF;
-	res = ((float) data) / 0x100000;
-	return (res * 200 - 50);
-}
-
-float aht_get_temp_f() {
-	return (aht_get_temp_c() * 9 / 5 + 32);
-}
-
-float aht_get_humidity() {
-	float res;
-	uint64_t data = aht_get_value();
-	data = data >> 20;
-	res = ((float) data) / 0x100000;
-	return (res * 100);
 }
 
 //------------------------- RTC utils -------------------------
@@ -464,7 +197,7 @@ void get_time() {
 	//Send word address of seconds
 	i2c_start();
 	i2c_write(RTC_ADDR | TW_WRITE);
-	i2c_write(0x03);
+	i2c_write(0x02);
 	//Restart in read mode
 	wait_i2c_ready();
 	i2c_start();
@@ -603,12 +336,20 @@ void set_time() {
 
 //------------------------- Update display value -------------------------
 
+//Measurements are oversampled to 12 bits with the CPU asleep then rounded back
+//to the 10 bits displayed, which keeps the last digit from flickering
+#define ADC_EXTRA_BITS 2
+
+uint16_t adc_sample() {
+	return ((adc_oversample(ADC_EXTRA_BITS) + (1 << (ADC_EXTRA_BITS - 1))) >> ADC_EXTRA_BITS);
+}
+
 void update_value_adc() {
-	uint_display(adc_get_conv());
+	uint_display(adc_sample());
 }
 
 void update_value_temp_int() {
-	uint16_t adc_value = adc_get_conv();
+	uint16_t adc_value = adc_sample();
 	uint_display(adc_value - 342);
 }
 
@@ -705,6 +446,7 @@ void unset_mode_rgb() {
 	//Turn off interrupts on timer 1
 	TIMSK1 &= ~(1 << OCIE1A);
 	set_all_rgb('0');
+	apa102_flush();
 	spi_disable();
 }
 
@@ -758,6 +500,7 @@ void set_mode(enum mode_e new_mode) {
 		break;
 	case hour:
 		unset_points();
+		//fall through
 	case date:
 	case year:
 		unset_mode_time();
@@ -790,6 +533,7 @@ void set_mode(enum mode_e new_mode) {
 		break;
 	case hour:
 		set_time_dots();
+		//fall through
 	case date:
 	case year:
 		set_mode_time(new_mode);
@@ -801,69 +545,29 @@ void set_mode(enum mode_e new_mode) {
 	mode = new_mode;
 }
 
-//------------------------- Interrupts -------------------------
+//------------------------- Tasks -------------------------
 
-ISR(TIMER0_OVF_vect) {
-	//Display current character on 7 segment display
-	//We first need to wipe the display to prevent ghosting
-	char c = display_str[display_position];
-	_Bool sw3_pressed = is_sw3_pressed();
-	i2c_start();
-	//Address io expander
-	i2c_write(IO_EXP_ADDR | TW_WRITE);
-	//Send output port 0 command and wipe
-	i2c_write(0x02);
-	i2c_write(255);
-	i2c_write(0);
-	wait_i2c_ready();
-	i2c_start();
-	i2c_write(IO_EXP_ADDR | TW_WRITE);
-	//Restart and display current digit
-	i2c_write(0x02);
-	//Set IO0 low on current digit CC and LEDs if switches are pressed
-	uint8_t io0 = (uint8_t) ~(1 << (4 + display_position));
-	if (sw1_pressed)
-		io0 &= ~(1 << 3);
-	if (sw2_pressed)
-		io0 &= ~(1 << 2);
-	if (sw3_pressed)
-		io0 &= ~(1 << 1);
-	i2c_write(io0);
-	//Set IO1 to display digit
-	if (decimal_mask & (1 << display_position))
-		i2c_write(get_segment_char(c) | (1 << 7));
-	else
-		i2c_write(get_segment_char(c));
-	i2c_stop();
-	display_position++;
-	if (display_position == 4)
-		display_position = 0;
-}
-
-ISR(TIMER2_OVF_vect) {
-	if (value_refresh_counter == 9) {
-		switch (mode) {
-		case potentiometer:
-		case photoresistor:
-		case thermistor:
-			update_value_adc();
-			break;
-		case temp_int:
-			update_value_temp_int();
-			break;
-		case temp_c:
-		case temp_f:
-		case humidity:
-			aht_request_measurement();
-			break;
-		}
-		value_refresh_counter = 0;
-	} else {
-		value_refresh_counter++;
+//Refresh the displayed measurement every 160ms
+void update_value() {
+	switch (mode) {
+	case potentiometer:
+	case photoresistor:
+	case thermistor:
+		update_value_adc();
+		break;
+	case temp_int:
+		update_value_temp_int();
+		break;
+	case temp_c:
+	case temp_f:
+	case humidity:
+		update_value_aht();
+		break;
 	}
 }
 
-ISR(TIMER1_COMPA_vect) {
+//Posted by timer 1 for the RGB effects and the clock modes
+void update_effect() {
 	switch (mode) {
 	case forty_two:
 		//Select next rgb effect
@@ -879,21 +583,6 @@ ISR(TIMER1_COMPA_vect) {
 		wheel_spi(rgb_position);
 		rgb_position++;
 		break;
-	case temp_c:
-		float_display(aht_get_temp_c());
-		if (display_str[0] == ' ')
-			display_str[0] = 'C';
-			break;
-	case temp_f:
-		float_display(aht_get_temp_f());
-		if (display_str[0] == ' ')
-			display_str[0] = 'F';
-		break;
-	case humidity:
-		float_display(aht_get_humidity());
-		if (display_str[0] == ' ')
-			display_str[0] = 'H';
-		break;
 	case hour:
 		increment_time();
 		update_value_time();
@@ -909,32 +598,103 @@ ISR(TIMER1_COMPA_vect) {
 	}
 }
 
-ISR(INT0_vect) {
-	sw1_pressed = !sw1_pressed;
-	if (sw1_pressed && mode != start) {
-		enum mode_e new_mode;
+sched_task value_task = SCHED_TASK("value", update_value);
+sched_task effect_task = SCHED_TASK("effect", update_effect);
+sched_task aht_task = SCHED_TASK("aht20", aht20_sampler_tick);
+
+void tasks_init() {
+	//Timer 0 ticks the scheduler: 256 counts of 64 cycles
+	sched_init(&TCNT0, 256, 64);
+	sched_add(&aht_task);
+	sched_add(&value_task);
+	sched_add(&effect_task);
+	sched_start(&aht_task, 0, AHT20_TICK_MS);
+}
+
+#ifdef PROF
+//p prints the interrupt profile, s the task run times and idle time, r resets
+//both
+void debug_poll() {
+	if (!uart_rx_available())
+		return;
+	switch (uart_rx()) {
+	case 'p':
+		prof_report();
+		break;
+	case 's':
+		sched_report();
+		break;
+	case 'r':
+		prof_reset();
+		sched_reset_stats();
+		uart_print_nl("profiler reset");
+		break;
+	}
+}
+#endif
+
+//------------------------- Interrupts -------------------------
+
+ISR(TIMER0_OVF_vect) {
+	PROF_ENTER(prof_timer0_ovf);
+	sched_tick();
+	button_tick();
+	//Display current character on 7 segment display
+	char c = display_str[display_position];
+	//Set IO0 low on current digit CC and LEDs if switches are pressed
+	uint8_t io0 = (uint8_t) ~(1 << (4 + display_position));
+	if (button_is_down(button_sw1))
+		io0 &= ~(1 << 3);
+	if (button_is_down(button_sw2))
+		io0 &= ~(1 << 2);
+	if (button_is_down(button_sw3))
+		io0 &= ~(1 << 1);
+	//Refresh SW3 once per display cycle, the value is used from a later tick
+	if (display_position == 0)
+		pca9555_poll();
+	//Set IO1 to display digit
+	uint8_t segments = seg7_char(c);
+	if (decimal_mask & (1 << display_position))
+		segments |= SEG7_DOT;
+	//Bus still busy with the previous digit, try again next tick
+	if (seg7_show_async(io0, segments)) {
+		display_position++;
+		if (display_position == 4)
+			display_position = 0;
+	}
+	PROF_EXIT(prof_timer0_ovf);
+}
+
+ISR(TIMER1_COMPA_vect) {
+	PROF_ENTER(prof_timer1_compa);
+	sched_post(&effect_task);
+	PROF_EXIT(prof_timer1_compa);
+}
+
+void handle_button(button_event event) {
+	if (event.type != button_press)
+		return;
+	enum mode_e new_mode;
+	//SW1 goes to the next mode, SW2 to the previous one
+	if (event.button == button_sw1) {
 		if (mode == year)
 			new_mode = 0;
 		else
 			new_mode = mode + 1;
-		set_mode(new_mode);
-	}
-	_delay_ms(10);
-	EIFR |= (1 << INTF0);
-}
-
-ISR(PCINT2_vect) {
-	sw2_pressed = !sw2_pressed;
-	if (sw2_pressed && mode != start) {
-		enum mode_e new_mode;
+	} else if (event.button == button_sw2) {
 		if (mode == 0)
 			new_mode = year;
 		else
 			new_mode = mode - 1;
-		set_mode(new_mode);
+	} else {
+		return;
+	}
+	//Runs with interrupts on, it waits for the RTC and the LED frame
+	set_mode(new_mode);
+	//Drop an effect step the old mode posted before its timer was stopped
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		sched_stop(&effect_task);
 	}
-	_delay_ms(10);
-	PCIFR |= (1 << PCIF2);
 }
 
 ISR(BADISR_vect) {
@@ -958,15 +718,37 @@ void start_animation() {
 
 int main() {
 	uart_init();
-	i2c_init();
+	i2c_init(i2c_profiles, I2C_PROFILE_COUNT(i2c_profiles));
 	io_init();
 	adc_init();
 	spi_master_init();
+	for (uint16_t i = 0; i < apa102_led_count; i++) {
+		apa102_set_brightness(i, 1);
+	}
 	set_all_rgb(0);
+	apa102_flush();
 	spi_disable();
+	tasks_init();
 	timers_init();
 	start_animation();
 	set_mode(potentiometer);
-	start_value_update_timer();
-	while (1) {}
+	sched_start(&value_task, 0, 160);
+#ifdef PROF
+	prof_init();
+	prof_name(prof_timer0_ovf, "TIMER0_OVF");
+	prof_name(prof_timer1_compa, "TIMER1_COMPA");
+#endif
+	button_event event;
+	//Presses during the start animation are ignored
+	while (button_poll(&event)) {}
+	while (1) {
+		if (button_poll(&event))
+			handle_button(event);
+#ifdef PROF
+		debug_poll();
+#endif
+		//Nothing was due, sleep until the next interrupt
+		if (!sched_run())
+			sched_idle();
+	}
 }